@@ -0,0 +1,68 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+//usage: bench [--warmup N] [--repetitions N] [--json report.json] [files or directories]...
+//without paths the lexer corpus is clua_examples, the synthetic inputs are always added
+int main(int argc, char** argv)
+{
+    LexerBench::Options options;
+
+    for (int argument = 1; argument < argc; argument++)
+    {
+        std::string_view flag(argv[argument]);
+        bool has_value = argument + 1 < argc;
+
+        if (flag == "--warmup" && has_value)
+        {
+            options.warmup = std::stoul(argv[++argument]);
+        }
+        else if (flag == "--repetitions" && has_value)
+        {
+            options.repetitions = std::max<size_t>(1, std::stoul(argv[++argument]));
+        }
+        else if (flag == "--json" && has_value)
+        {
+            options.json_path = argv[++argument];
+        }
+        else if (flag.starts_with("--"))
+        {
+            std::cerr << "usage: bench [--warmup N] [--repetitions N] [--json report.json] [files or directories]..." << std::endl;
+            return 1;
+        }
+        else
+        {
+            options.paths.emplace_back(flag);
+        }
+    }
+
+    if (options.paths.empty())
+    {
+        options.paths.emplace_back("clua_examples");
+    }
+
+    auto symbol_status = run_symbol_bench();
+
+    auto corpus = LexerBench::build_corpus(options);
+    std::vector<LexerBench::Result> results;
+    for (auto& entry : corpus)
+    {
+        results.push_back(LexerBench::run(entry, options));
+    }
+
+    LexerBench::print_text_report(results, std::cout);
+
+    if (!options.json_path.empty())
+    {
+        std::ofstream json_output(options.json_path);
+        if (!json_output)
+        {
+            std::cerr << "Could not write " << options.json_path << std::endl;
+            return 1;
+        }
+        LexerBench::write_json_report(results, options, json_output);
+    }
+
+    return symbol_status;
+}
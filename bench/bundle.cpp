@@ -0,0 +1,6 @@
+#include <symbol_bench.cpp>
+#include <lexer_bench.cpp>
+#include <bench_main.cpp>
+#include <lexer/lexer.cpp>
+#include <lexer/streaming_lexer.cpp>
+#include <driver/lex_driver.cpp>
\ No newline at end of file
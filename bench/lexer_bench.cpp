@@ -0,0 +1,344 @@
+#include <lexer/lexer.hpp>
+#include <driver/lex_driver.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//Throughput of Lexer::tokenize_all over the clua_examples files and synthetic stress inputs.
+//Every input is lexed passes times per repetition so short files still run long enough to time,
+//the median repetition is reported next to the fastest one.
+namespace LexerBench {
+
+    struct Options {
+        size_t warmup = 3;
+        size_t repetitions = 10;
+        size_t bytes_per_repetition = 8 * 1024 * 1024; //a file is lexed again until a repetition covers this much
+        std::vector<std::string> paths;
+        std::string json_path; //empty for no JSON report
+    };
+
+    struct CorpusEntry {
+        std::string name;
+        Util::PaddedSource source;
+    };
+
+    struct TokenTypeTotals {
+        size_t count = 0;
+        size_t bytes = 0;
+    };
+
+    struct Result {
+        std::string name;
+        size_t bytes = 0;
+        size_t tokens = 0;
+        size_t errors = 0;
+        size_t passes = 0;
+        std::vector<double> repetition_ns;
+        double median_ns = 0;
+        double min_ns = 0;
+        TokenTypeTotals token_types[static_cast<size_t>(Util::TokenType::None) + 1];
+
+        double megabytes_per_second() const
+        {
+            return median_ns > 0 ? bytes * passes / (median_ns * 1e-9) / (1024.0 * 1024.0) : 0;
+        }
+
+        double tokens_per_second() const
+        {
+            return median_ns > 0 ? tokens * passes / (median_ns * 1e-9) : 0;
+        }
+
+        double ns_per_token() const
+        {
+            return tokens > 0 ? median_ns / (tokens * passes) : 0;
+        }
+    };
+
+    const char* token_type_name(Util::TokenType token_type)
+    {
+        using Util::TokenType;
+
+        switch (token_type)
+        {
+        case TokenType::Identifier: return "Identifier";
+        case TokenType::Numeric: return "Numeric";
+        case TokenType::Symbol: return "Symbol";
+        case TokenType::Whitespace: return "Whitespace";
+        case TokenType::NewLine: return "NewLine";
+        case TokenType::Comment: return "Comment";
+        case TokenType::String: return "String";
+        case TokenType::Char: return "Char";
+        case TokenType::EndOfFile: return "EndOfFile";
+        case TokenType::LuaBlock: return "LuaBlock";
+        case TokenType::Error: return "Error";
+        case TokenType::None: return "None";
+        }
+        return "None";
+    }
+
+    //small deterministic generator, so the synthetic inputs are the same on every run and machine
+    struct Random {
+        uint64_t state = 0x2545F4914F6CDD1Dull;
+
+        size_t next(size_t bound)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state % bound;
+        }
+    };
+
+    std::string make_identifier_dense_input(size_t target_size)
+    {
+        const char* words[] = {
+            "player", "velocity", "frame_count", "delta", "mathModule", "x", "i", "accumulated_force_vector",
+            "int", "float", "return", "virtual", "extern", "buffer", "vec3", "static_cast", "apply", "tick",
+        };
+
+        Random random;
+        std::string input;
+        while (input.size() < target_size)
+        {
+            input += words[random.next(std::size(words))];
+            input += random.next(8) == 0 ? '\n' : ' ';
+        }
+        return input;
+    }
+
+    std::string make_comment_heavy_input(size_t target_size)
+    {
+        std::string input;
+        for (size_t line = 0; input.size() < target_size; line++)
+        {
+            switch (line % 4)
+            {
+            case 0: input += "// a line comment that explains the next statement in more words than it needs\n"; break;
+            case 1: input += "int value = 0; // trailing comment\n"; break;
+            case 2: input += "/* a block comment\n   spanning lines, with * and / inside * / but not closed early\n*/\n"; break;
+            case 3: input += "    /**/ float scale = 0.5; /* inline */\n"; break;
+            }
+        }
+        return input;
+    }
+
+    std::string make_lua_block_heavy_input(size_t target_size)
+    {
+        std::string input;
+        while (input.size() < target_size)
+        {
+            input +=
+                "int a = 0;\n"
+                "@LUA [&a, b]{\n"
+                "    local t = { 1, 2, \"three\", 'four' } -- trailing } in a comment\n"
+                "    for i = 1, #t do a += t[i] end\n"
+                "    local s = [==[ long ]] string ]==] --[[ long\n comment ]]\n"
+                "    if b ~= nil then print(\"}\", b) end\n"
+                "} export [b] as [a];\n";
+        }
+        return input;
+    }
+
+    std::vector<CorpusEntry> build_corpus(const Options& options)
+    {
+        constexpr size_t synthetic_size = 4 * 1024 * 1024;
+
+        std::vector<CorpusEntry> corpus;
+
+        auto files = Driver::collect_clua_files(options.paths);
+        std::sort(files.begin(), files.end());
+
+        for (const auto& path : files)
+        {
+            auto file_input = Util::PaddedSource::from_file(path.c_str());
+            if (!file_input)
+            {
+                std::cerr << "Could not read " << path << std::endl;
+                continue;
+            }
+            corpus.push_back({ path, std::move(*file_input) });
+        }
+
+        auto operator_dense = make_operator_dense_input(1);
+        operator_dense = make_operator_dense_input(synthetic_size / operator_dense.size());
+
+        corpus.push_back({ "synthetic/operator_dense", Util::PaddedSource(operator_dense) });
+        corpus.push_back({ "synthetic/identifier_dense", Util::PaddedSource(make_identifier_dense_input(synthetic_size)) });
+        corpus.push_back({ "synthetic/comment_heavy", Util::PaddedSource(make_comment_heavy_input(synthetic_size)) });
+        corpus.push_back({ "synthetic/lua_block_heavy", Util::PaddedSource(make_lua_block_heavy_input(synthetic_size)) });
+
+        return corpus;
+    }
+
+    Result run(CorpusEntry& entry, const Options& options)
+    {
+        Result result;
+        result.name = entry.name;
+        result.bytes = entry.source.size();
+        result.passes = std::max<size_t>(1, options.bytes_per_repetition / std::max<size_t>(result.bytes, 1));
+
+        //the same reuse as the lex driver: one arena, lexer and token buffer, reset between passes
+        Util::Arena arena;
+        Util::Lexer lexer(arena);
+        std::vector<Util::TokenGeneric> tokens;
+
+        auto lex_passes = [&]() {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t pass = 0; pass < result.passes; pass++)
+            {
+                auto source = entry.source.view();
+                arena.reset();
+                lexer.reset(source);
+                tokens.clear();
+                lexer.tokenize_all(tokens);
+            }
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count();
+        };
+
+        for (size_t repetition = 0; repetition < options.warmup; repetition++)
+        {
+            lex_passes();
+        }
+
+        for (size_t repetition = 0; repetition < options.repetitions; repetition++)
+        {
+            result.repetition_ns.push_back(lex_passes());
+        }
+
+        auto sorted_ns = result.repetition_ns;
+        std::sort(sorted_ns.begin(), sorted_ns.end());
+        if (!sorted_ns.empty())
+        {
+            auto middle = sorted_ns.size() / 2;
+            result.median_ns = sorted_ns.size() % 2 ? sorted_ns[middle] : (sorted_ns[middle - 1] + sorted_ns[middle]) / 2;
+            result.min_ns = sorted_ns.front();
+        }
+
+        //the breakdown comes from the last pass, every pass lexes the same tokens
+        result.tokens = tokens.size();
+        for (const auto& token : tokens)
+        {
+            auto& totals = result.token_types[static_cast<size_t>(token.token_type)];
+            totals.count++;
+            totals.bytes += token.length;
+            result.errors += token.token_type == Util::TokenType::Error;
+        }
+
+        return result;
+    }
+
+    void print_text_report(const std::vector<Result>& results, std::ostream& output)
+    {
+        char line[256];
+
+        output << "[BENCH] lexer throughput, median of the repetitions\n";
+        for (const auto& result : results)
+        {
+            std::snprintf(line, sizeof(line), "  %-32s %10zu bytes %9zu tokens %9.1f MB/s %12.0f tokens/s %7.2f ns/token%s\n",
+                result.name.c_str(), result.bytes, result.tokens, result.megabytes_per_second(), result.tokens_per_second(),
+                result.ns_per_token(), result.errors ? " (has errors)" : "");
+            output << line;
+
+            for (size_t type_index = 0; type_index <= static_cast<size_t>(Util::TokenType::None); type_index++)
+            {
+                const auto& totals = result.token_types[type_index];
+                if (totals.count == 0)
+                {
+                    continue;
+                }
+
+                std::snprintf(line, sizeof(line), "      %-12s %9zu tokens %5.1f%% %10zu bytes %5.1f%%\n",
+                    token_type_name(static_cast<Util::TokenType>(type_index)),
+                    totals.count, 100.0 * totals.count / std::max<size_t>(result.tokens, 1),
+                    totals.bytes, 100.0 * totals.bytes / std::max<size_t>(result.bytes, 1));
+                output << line;
+            }
+        }
+    }
+
+    void write_json_string(std::ostream& output, const std::string& text)
+    {
+        output << '"';
+        for (unsigned char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                output << '\\' << character;
+            }
+            else if (character < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+                output << escaped;
+            }
+            else
+            {
+                output << character;
+            }
+        }
+        output << '"';
+    }
+
+    //one object per corpus entry, numbers are plain so tools can diff reports across releases
+    void write_json_report(const std::vector<Result>& results, const Options& options, std::ostream& output)
+    {
+        output.precision(6);
+        output << std::fixed;
+
+        output << "{\n";
+        output << "  \"benchmark\": \"lexer\",\n";
+        output << "  \"warmup\": " << options.warmup << ",\n";
+        output << "  \"repetitions\": " << options.repetitions << ",\n";
+        output << "  \"results\": [";
+
+        for (size_t result_index = 0; result_index < results.size(); result_index++)
+        {
+            const auto& result = results[result_index];
+
+            output << (result_index ? ",\n" : "\n") << "    {\n";
+            output << "      \"name\": ";
+            write_json_string(output, result.name);
+            output << ",\n";
+            output << "      \"bytes\": " << result.bytes << ",\n";
+            output << "      \"tokens\": " << result.tokens << ",\n";
+            output << "      \"errors\": " << result.errors << ",\n";
+            output << "      \"passes\": " << result.passes << ",\n";
+            output << "      \"median_ns\": " << result.median_ns << ",\n";
+            output << "      \"min_ns\": " << result.min_ns << ",\n";
+            output << "      \"megabytes_per_second\": " << result.megabytes_per_second() << ",\n";
+            output << "      \"tokens_per_second\": " << result.tokens_per_second() << ",\n";
+            output << "      \"ns_per_token\": " << result.ns_per_token() << ",\n";
+
+            output << "      \"repetition_ns\": [";
+            for (size_t repetition = 0; repetition < result.repetition_ns.size(); repetition++)
+            {
+                output << (repetition ? ", " : "") << result.repetition_ns[repetition];
+            }
+            output << "],\n";
+
+            output << "      \"token_types\": {";
+            bool first_type = true;
+            for (size_t type_index = 0; type_index <= static_cast<size_t>(Util::TokenType::None); type_index++)
+            {
+                const auto& totals = result.token_types[type_index];
+                if (totals.count == 0)
+                {
+                    continue;
+                }
+
+                output << (first_type ? "\n" : ",\n") << "        \"" << token_type_name(static_cast<Util::TokenType>(type_index))
+                    << "\": { \"count\": " << totals.count << ", \"bytes\": " << totals.bytes << " }";
+                first_type = false;
+            }
+            output << "\n      }\n    }";
+        }
+
+        output << "\n  ]\n}\n";
+    }
+};
@@ -0,0 +1,149 @@
+#include <lexer/lexer.hpp>
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+
+//the lookup the trie replaced, kept around so the benchmark has something to compare against
+namespace LegacySymbolClassifier {
+    using SymbolClassifier::SymbolKind;
+
+    const auto normalized_symbols = [](){
+        std::unordered_map<std::string, SymbolKind> normalized_symbols;
+        for (const auto& [symbol_str, kind] : SymbolClassifier::normalized_symbols)
+        {
+            normalized_symbols.emplace(std::string(symbol_str), kind);
+        }
+        return normalized_symbols;
+    }();
+
+    SymbolKind get_symbol_from_buffer_fragment(const char* buffer_fragment, size_t length)
+    {
+        for (const auto& [symbol_str, kind] : normalized_symbols)
+        {
+            if (symbol_str.size() == length && symbol_str.compare(0, length, buffer_fragment, length) == 0)
+                return kind;
+        }
+        return SymbolKind::UNKNOWN;
+    }
+
+    size_t match_symbol(const char* buffer, size_t available, SymbolKind& symbol_kind)
+    {
+        size_t length = 0;
+        symbol_kind = SymbolKind::UNKNOWN;
+        while (length < available)
+        {
+            auto next_symbol = get_symbol_from_buffer_fragment(buffer, length + 1);
+            if (next_symbol == SymbolKind::UNKNOWN)
+                break;
+            symbol_kind = next_symbol;
+            length++;
+        }
+        return length;
+    }
+};
+
+namespace TrieSymbolClassifier {
+    using namespace SymbolClassifier;
+
+    size_t match_symbol(const char* buffer, size_t available, SymbolKind& symbol_kind)
+    {
+        size_t length = 0;
+        auto node = SymbolTrie::root_node;
+        while (length < available)
+        {
+            auto next_node = SymbolTrie::advance(node, static_cast<unsigned char>(buffer[length]));
+            if (next_node == SymbolTrie::root_node)
+                break;
+            node = next_node;
+            length++;
+        }
+        symbol_kind = SymbolTrie::kind_of(node);
+        return length;
+    }
+};
+
+std::string make_operator_dense_input(size_t repetitions)
+{
+    std::string input;
+    for (size_t i = 0; i < repetitions; i++)
+    {
+        input += "a<<=b>>=c->d&&e||f!=g==h++--i?=j<=k>=l^=m|=n&=o%=p*=q/=r[s](t){u};v,w.x:y~z!";
+    }
+    return input;
+}
+
+template <typename Matcher>
+double time_matcher(const std::string& input, Matcher matcher, size_t& symbol_count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    size_t checksum = 0;
+    symbol_count = 0;
+    size_t index = 0;
+    while (index < input.size())
+    {
+        SymbolClassifier::SymbolKind symbol_kind;
+        auto length = matcher(input.data() + index, input.size() - index, symbol_kind);
+        if (length == 0)
+        {
+            index++;
+            continue;
+        }
+        checksum += static_cast<size_t>(symbol_kind);
+        symbol_count++;
+        index += length;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    volatile size_t sink = checksum;
+    (void)sink;
+
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double time_lexer(std::string& input, size_t& token_count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Util::Source source(reinterpret_cast<unsigned char*>(input.data()), input.size());
+    Util::Lexer lexer(source);
+
+    token_count = 0;
+    auto token = lexer.process_next_token();
+    while (token.token_type != Util::TokenType::EndOfFile)
+    {
+        token_count++;
+        token = lexer.process_next_token();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+int run_symbol_bench()
+{
+    auto input = make_operator_dense_input(20000);
+
+    size_t legacy_count = 0;
+    size_t trie_count = 0;
+    size_t token_count = 0;
+
+    //warmup
+    time_matcher(input, LegacySymbolClassifier::match_symbol, legacy_count);
+    time_matcher(input, TrieSymbolClassifier::match_symbol, trie_count);
+
+    auto legacy_ns = time_matcher(input, LegacySymbolClassifier::match_symbol, legacy_count);
+    auto trie_ns = time_matcher(input, TrieSymbolClassifier::match_symbol, trie_count);
+    auto lexer_ns = time_lexer(input, token_count);
+
+    std::cout << "[BENCH] symbol matching on " << input.size() << " bytes of operator-dense input\n";
+    std::cout << "  unordered_map scan: " << legacy_ns / legacy_count << " ns/symbol\n";
+    std::cout << "  trie:               " << trie_ns / trie_count << " ns/symbol\n";
+    std::cout << "  speedup:            " << legacy_ns / trie_ns << "x\n";
+    std::cout << "  full lexer:         " << lexer_ns / token_count << " ns/token\n";
+
+    return legacy_count == trie_count ? 0 : 1;
+}
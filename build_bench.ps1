@@ -0,0 +1,7 @@
+g++ -std=c++26 bench/bundle.cpp -I"C:/dev/C_C++/StdToolset/" -I"src" -I"bench" -O3 -DNDEBUG -o "build/bench.exe"
+
+if ($LASTEXITCODE -ne 0) {
+    Write-Error "Compilation failed (exit code $LASTEXITCODE)"
+    exit $LASTEXITCODE
+}
+./build/bench.exe @args
\ No newline at end of file
@@ -0,0 +1,15 @@
+#!/bin/sh
+# Usage: ./build_bench.sh [bench arguments], e.g. ./build_bench.sh --repetitions 20 --json build/bench.json
+# STD_TOOLSET points at the directory holding DebuggerAssets/
+
+STD_TOOLSET="${STD_TOOLSET:-../StdToolset}"
+
+mkdir -p build
+
+g++ -std=c++2b bench/bundle.cpp -I"$STD_TOOLSET" -I"src" -I"bench" -O3 -DNDEBUG -pthread -o "build/bench" || {
+    status=$?
+    echo "Compilation failed (exit code $status)" >&2
+    exit $status
+}
+
+./build/bench "$@"
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <algorithm>
+
+namespace Util {
+
+    struct ArenaStats {
+        size_t used_bytes = 0;      //handed out since the last reset, alignment padding included
+        size_t reserved_bytes = 0;  //sum of all block sizes, kept across resets
+        size_t high_water_mark = 0; //largest used_bytes ever seen, a good size for the first block
+        size_t block_count = 0;
+        size_t reset_count = 0;
+    };
+
+    //Bump allocator for everything whose lifetime is "one file". Nothing is freed individually,
+    //reset() rewinds to the first block and keeps every block for the next file, so steady state never calls malloc.
+    //Destructors are not run, only trivially destructible objects should be created directly in it.
+    class Arena {
+        private:
+        struct Block {
+            std::unique_ptr<std::byte[]> memory;
+            size_t size = 0;
+        };
+
+        std::vector<Block> blocks;
+        size_t block_size;
+        size_t current_block = 0;
+        size_t block_offset = 0;
+        ArenaStats arena_stats;
+
+        void* allocate_slow(size_t size, size_t alignment)
+        {
+            //skip to the next kept block that fits, only allocate once none does
+            for (current_block = blocks.empty() ? 0 : current_block + 1; current_block < blocks.size(); current_block++)
+            {
+                if (blocks[current_block].size >= size + alignment)
+                {
+                    break;
+                };
+            };
+
+            if (current_block == blocks.size())
+            {
+                Block block;
+                block.size = std::max(block_size,size + alignment);
+                block.memory.reset(new std::byte[block.size]);
+                arena_stats.reserved_bytes += block.size;
+                blocks.push_back(std::move(block));
+                arena_stats.block_count = blocks.size();
+            };
+
+            block_offset = 0;
+            return allocate(size,alignment);
+        };
+
+        public:
+        explicit Arena(size_t block_size = 64 * 1024) : block_size(block_size)
+        {};
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        Arena(Arena&&) = default;
+        Arena& operator=(Arena&&) = default;
+
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+        {
+            if (current_block < blocks.size()) [[likely]]
+            {
+                auto& block = blocks[current_block];
+                auto base = reinterpret_cast<uintptr_t>(block.memory.get());
+                auto aligned_offset = ((base + block_offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+
+                if (aligned_offset + size <= block.size)
+                {
+                    arena_stats.used_bytes += aligned_offset + size - block_offset;
+                    arena_stats.high_water_mark = std::max(arena_stats.high_water_mark,arena_stats.used_bytes);
+                    block_offset = aligned_offset + size;
+                    return block.memory.get() + aligned_offset;
+                };
+            };
+
+            return allocate_slow(size,alignment);
+        };
+
+        template <typename T>
+        T* allocate_array(size_t count)
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count,alignof(T)));
+        };
+
+        template <typename T, typename... Arguments>
+        T* create(Arguments&&... arguments)
+        {
+            static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+            return new (allocate(sizeof(T),alignof(T))) T(std::forward<Arguments>(arguments)...);
+        };
+
+        //everything allocated so far becomes invalid, the blocks stay reserved
+        void reset()
+        {
+            current_block = 0;
+            block_offset = 0;
+            arena_stats.used_bytes = 0;
+            arena_stats.reset_count++;
+        };
+
+        //gives the blocks back to the system as well
+        void release()
+        {
+            reset();
+            blocks.clear();
+            arena_stats.reserved_bytes = 0;
+            arena_stats.block_count = 0;
+        };
+
+        inline const ArenaStats& stats() const noexcept
+        {
+            return arena_stats;
+        };
+    };
+
+    //Standard allocator over an Arena, a null arena falls back to the global heap so containers stay default constructible.
+    template <typename T>
+    struct ArenaAllocator {
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        Arena* arena = nullptr;
+
+        ArenaAllocator() noexcept = default;
+        ArenaAllocator(Arena* arena) noexcept : arena(arena)
+        {};
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena)
+        {};
+
+        T* allocate(size_t count)
+        {
+            if (arena)
+            {
+                return arena->allocate_array<T>(count);
+            };
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        };
+
+        void deallocate(T* pointer, size_t)
+        {
+            if (!arena)
+            {
+                ::operator delete(pointer);
+            };
+        };
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const noexcept
+        {
+            return arena == other.arena;
+        };
+    };
+
+    template <typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+}
@@ -1,3 +1,9 @@
 #include "main.cpp"
 #include "lexer/lexer.cpp"
-#include "parser/parser.cpp"
\ No newline at end of file
+#include "lexer/parallel_lexer.cpp"
+#include "lexer/incremental_lexer.cpp"
+#include "lexer/streaming_lexer.cpp"
+#include "driver/lex_driver.cpp"
+#include "parser/parser.cpp"
+#include "diagnostics/diagnostics.cpp"
+#include "driver/check_driver.cpp"
\ No newline at end of file
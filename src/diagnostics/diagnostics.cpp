@@ -0,0 +1,176 @@
+#include <diagnostics/diagnostics.hpp>
+
+#include <algorithm>
+
+namespace Diagnostics {
+
+   const char* describe(Util::ErrorCode error_code)
+   {
+      using Util::ErrorCode;
+
+      switch (error_code)
+      {
+      case ErrorCode::UnknownSymbol: return "unknown symbol";
+      case ErrorCode::UnexpectedCharacter: return "unexpected character";
+      case ErrorCode::UnexpectedTokenType: return "unexpected token";
+      case ErrorCode::InvalidByte: return "malformed UTF-8";
+      case ErrorCode::TruncatedUnicodeSequence: return "UTF-8 sequence cut off by the end of the file";
+      case ErrorCode::TruncatedNumberSequence: return "number has no digits";
+      case ErrorCode::MalformedNumber: return "malformed number";
+      case ErrorCode::UnclosedComment: return "unclosed block comment";
+      case ErrorCode::UnclosedString: return "unclosed string";
+      case ErrorCode::UnclosedChar: return "unclosed char";
+      case ErrorCode::InvalidCharCode: return "invalid char";
+      case ErrorCode::TooLongChar: return "char holds more than one character";
+      case ErrorCode::UnclosedLuaBlock: return "unclosed lua block";
+      case ErrorCode::NumberOverflow: return "number is too large";
+      case ErrorCode::SourceTooLarge: return "file is larger than 4 GiB";
+      default: return "error";
+      };
+   };
+
+   const char* describe(ASTParser::ParseErrorCode error_code)
+   {
+      using ASTParser::ParseErrorCode;
+
+      switch (error_code)
+      {
+      case ParseErrorCode::UnexpectedToken: return "unexpected token";
+      case ParseErrorCode::ExpectedExpression: return "expected an expression";
+      case ParseErrorCode::ExpectedIdentifier: return "expected a name";
+      case ParseErrorCode::ExpectedSymbol: return "expected";
+      case ParseErrorCode::ExpectedTerminator: return "expected ';' or a new line";
+      case ParseErrorCode::ExpectedLua: return "expected @LUA [captures]{ ... }";
+      case ParseErrorCode::LexerError: return "invalid token";
+      default: return "error";
+      };
+   };
+
+   std::string_view symbol_text(SymbolClassifier::SymbolKind symbol_kind)
+   {
+      for (const auto& [symbol, kind] : SymbolClassifier::normalized_symbols)
+      {
+         if (kind == symbol_kind)
+         {
+            return symbol;
+         };
+      };
+      return "symbol";
+   };
+
+   const char* describe_number_flag(uint8_t number_flag)
+   {
+      switch (number_flag)
+      {
+      case Util::NumberFlags::PrecisionLoss: return "number has more digits than a double holds, it is rounded";
+      case Util::NumberFlags::Underflow: return "number is too small for a double";
+      default: return "number";
+      };
+   };
+
+   void DiagnosticList::add_ast(const ASTParser::Ast& ast)
+   {
+      add_lexer_errors(ast.tokens.errors);
+
+      for (size_t token_index = 0; token_index < ast.tokens.size(); token_index++)
+      {
+         if (ast.tokens.type(token_index) != Util::TokenType::Numeric)
+         {
+            continue;
+         };
+
+         for (auto number_flag : { Util::NumberFlags::PrecisionLoss, Util::NumberFlags::Underflow })
+         {
+            if (ast.tokens.number(token_index).flags & number_flag)
+            {
+               Diagnostic diagnostic;
+               diagnostic.severity = Severity::Warning;
+               diagnostic.origin = Origin::Number;
+               diagnostic.code = number_flag;
+               diagnostic.offset = ast.tokens.offset(token_index);
+               diagnostic.length = ast.tokens.length(token_index);
+               add(diagnostic);
+            };
+         };
+      };
+
+      for (const auto& error : ast.errors)
+      {
+         if (ast.tokens.type(error.token) == Util::TokenType::Error)
+         {
+            continue;
+         };
+
+         Diagnostic diagnostic;
+         diagnostic.origin = Origin::Parser;
+         diagnostic.code = static_cast<uint8_t>(error.error_code);
+         diagnostic.expected_symbol = error.expected_symbol;
+         diagnostic.offset = ast.tokens.offset(error.token);
+         diagnostic.length = ast.tokens.length(error.token);
+         add(diagnostic);
+      };
+   };
+
+   void DiagnosticList::sort()
+   {
+      std::stable_sort(diagnostics.begin(),diagnostics.end(),[](const Diagnostic& left, const Diagnostic& right) {
+         return left.offset < right.offset;
+      });
+   };
+
+   size_t DiagnosticList::error_count() const
+   {
+      return std::count_if(diagnostics.begin(),diagnostics.end(),[](const Diagnostic& diagnostic) {
+         return diagnostic.severity == Severity::Error;
+      });
+   };
+
+   Location DiagnosticList::locate(size_t offset) const
+   {
+      return line_index.locate(offset);
+   };
+
+   std::string DiagnosticList::message(const Diagnostic& diagnostic) const
+   {
+      if (diagnostic.origin == Origin::Lexer)
+      {
+         return describe(static_cast<Util::ErrorCode>(diagnostic.code));
+      };
+
+      if (diagnostic.origin == Origin::Number)
+      {
+         return describe_number_flag(diagnostic.code);
+      };
+
+      auto error_code = static_cast<ASTParser::ParseErrorCode>(diagnostic.code);
+      std::string text = describe(error_code);
+
+      if (error_code == ASTParser::ParseErrorCode::ExpectedSymbol)
+      {
+         text += " '";
+         text += symbol_text(diagnostic.expected_symbol);
+         text += "'";
+      };
+
+      return text;
+   };
+
+   std::string DiagnosticList::format(const Diagnostic& diagnostic, std::string_view path) const
+   {
+      auto location = locate(diagnostic.offset);
+
+      std::string text(path);
+      text += ":" + std::to_string(location.line) + ":" + std::to_string(location.column) + ": ";
+      text += diagnostic.severity == Severity::Error ? "error: " : "warning: ";
+      text += message(diagnostic);
+      return text;
+   };
+
+   DiagnosticList collect(const ASTParser::Ast& ast, std::string_view source_text)
+   {
+      DiagnosticList diagnostics(source_text);
+      diagnostics.add_ast(ast);
+      diagnostics.sort();
+      return diagnostics;
+   };
+}
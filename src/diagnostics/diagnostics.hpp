@@ -0,0 +1,115 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+#include <lexer/line_index.hpp>
+#include <parser/ast.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Diagnostics {
+
+    enum class Severity: uint8_t {
+        Error,
+        Warning,
+    };
+
+    enum class Origin: uint8_t {
+        Lexer,
+        Parser,
+        Number, //warnings about a literal's value, code is one of Util::NumberFlags
+    };
+
+    struct Diagnostic {
+        Severity severity = Severity::Error;
+        Origin origin = Origin::Lexer;
+        uint8_t code = 0; //a Util::ErrorCode, an ASTParser::ParseErrorCode or a Util::NumberFlags bit, depending on origin
+        SymbolClassifier::SymbolKind expected_symbol = SymbolClassifier::SymbolKind::UNKNOWN;
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    using Location = Util::SourceLocation;
+
+    //Every diagnostic of one file, gathered in a single pass over what the lexer and the parser recorded.
+    //Positions stay byte offsets until a location is asked for, the line index behind locate() is only built then
+    class DiagnosticList {
+        private:
+        std::string_view source_text;
+        std::vector<Diagnostic> diagnostics;
+        Util::LineIndex line_index;
+
+        public:
+        explicit DiagnosticList(std::string_view source_text) : source_text(source_text), line_index(source_text)
+        {};
+
+        inline void add(const Diagnostic& diagnostic)
+        {
+            diagnostics.push_back(diagnostic);
+        };
+
+        //a LexerContext's or a TokenStream's error table
+        template <typename Errors>
+        void add_lexer_errors(const Errors& errors)
+        {
+            for (const auto& error : errors)
+            {
+                Diagnostic diagnostic;
+                diagnostic.origin = Origin::Lexer;
+                diagnostic.code = static_cast<uint8_t>(error.error_code);
+                diagnostic.offset = error.offset;
+                diagnostic.length = error.length;
+                add(diagnostic);
+            };
+        };
+
+        //the lexer errors and number warnings of the tokens the parser pulled and the parse errors,
+        //except those sitting on an error token since the lexer already reported that spot
+        void add_ast(const ASTParser::Ast& ast);
+
+        //by position, diagnostics at the same offset keep the order they were added in
+        void sort();
+
+        inline size_t size() const noexcept
+        {
+            return diagnostics.size();
+        };
+
+        inline bool empty() const noexcept
+        {
+            return diagnostics.empty();
+        };
+
+        inline const Diagnostic& operator[](size_t diagnostic_index) const
+        {
+            return diagnostics[diagnostic_index];
+        };
+
+        inline auto begin() const noexcept
+        {
+            return diagnostics.begin();
+        };
+
+        inline auto end() const noexcept
+        {
+            return diagnostics.end();
+        };
+
+        size_t error_count() const;
+
+        Location locate(size_t offset) const;
+
+        std::string message(const Diagnostic& diagnostic) const;
+
+        //path:line:column: error: message
+        std::string format(const Diagnostic& diagnostic, std::string_view path) const;
+    };
+
+    const char* describe(Util::ErrorCode error_code);
+    const char* describe(ASTParser::ParseErrorCode error_code);
+
+    //parses nothing itself, collects and sorts everything recorded while the ast was built
+    DiagnosticList collect(const ASTParser::Ast& ast, std::string_view source_text);
+}
@@ -0,0 +1,67 @@
+#include <driver/check_driver.hpp>
+#include <driver/lex_driver.hpp>
+#include <parser/parser.hpp>
+
+#include <iostream>
+
+namespace Driver {
+
+   CheckFileResult check_file(const std::string& path, std::ostream& output, Util::Interner& interner)
+   {
+      CheckFileResult result;
+      result.path = path;
+
+      auto padded_input = Util::PaddedSource::from_file(path.c_str());
+      if (!padded_input)
+      {
+         result.too_large = is_too_large(path);
+         return result;
+      };
+      result.readable = true;
+
+      Util::Source source = padded_input->view();
+      Util::Arena arena;
+
+      auto ast = ASTParser::Parser(source,arena,interner).parse();
+      auto source_text = std::string_view(reinterpret_cast<const char*>(padded_input->data()),padded_input->size());
+      auto diagnostics = Diagnostics::collect(ast,source_text);
+
+      for (const auto& diagnostic : diagnostics)
+      {
+         output << diagnostics.format(diagnostic,path) << "\n";
+      };
+
+      result.error_count = diagnostics.error_count();
+      return result;
+   };
+
+   int run_clua_check(int argc, char** argv)
+   {
+      std::vector<std::string> paths(argv,argv + argc);
+      auto files = collect_clua_files(paths);
+
+      if (files.empty())
+      {
+         std::cerr << "usage: clua-check <files or directories>..." << std::endl;
+         return 1;
+      };
+
+      size_t total_errors = 0;
+      bool all_readable = true;
+      Util::Interner interner;
+
+      for (const auto& file : files)
+      {
+         auto result = check_file(file,std::cout,interner);
+         if (!result.readable)
+         {
+            std::cerr << describe_unreadable(file,result.too_large) << std::endl;
+            all_readable = false;
+         };
+         total_errors += result.error_count;
+      };
+
+      std::cout << "files: " << files.size() << " errors: " << total_errors << std::endl;
+      return all_readable && total_errors == 0 ? 0 : 1;
+   };
+}
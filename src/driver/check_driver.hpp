@@ -0,0 +1,22 @@
+#pragma once
+
+#include <diagnostics/diagnostics.hpp>
+
+#include <ostream>
+#include <string>
+
+namespace Driver {
+
+    struct CheckFileResult {
+        std::string path;
+        size_t error_count = 0;
+        bool readable = false;
+        bool too_large = false; //not readable because it is past Util::max_source_size
+    };
+
+    //lexes and parses the file once and writes every diagnostic of it to output, its identifiers are interned into interner
+    CheckFileResult check_file(const std::string& path, std::ostream& output, Util::Interner& interner);
+
+    //entry for `clua-check <files or directories>...`, prints path:line:column: diagnostics and fails on any error
+    int run_clua_check(int argc, char** argv);
+}
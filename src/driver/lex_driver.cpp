@@ -0,0 +1,266 @@
+#include <driver/lex_driver.hpp>
+#include <driver/thread_pool.hpp>
+#include <lexer/streaming_lexer.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <string_view>
+
+namespace Driver {
+
+   std::vector<std::string> collect_clua_files(const std::vector<std::string>& paths)
+   {
+      std::vector<std::string> files;
+
+      for (const auto& path : paths)
+      {
+         std::error_code error;
+         if (!std::filesystem::is_directory(path,error))
+         {
+            files.push_back(path);
+            continue;
+         };
+
+         for (const auto& entry : std::filesystem::recursive_directory_iterator(path,error))
+         {
+            if (entry.is_regular_file(error) && entry.path().extension() == ".clua")
+            {
+               files.push_back(entry.path().string());
+            };
+         };
+      };
+
+      return files;
+   };
+
+   bool is_too_large(const std::string& path)
+   {
+      std::error_code error;
+      auto file_size = std::filesystem::file_size(path,error);
+      return !error && file_size > Util::max_source_size;
+   };
+
+   std::string describe_unreadable(const std::string& path, bool too_large)
+   {
+      return too_large ? path + " is larger than the 4 GiB a source can have" : "Could not read " + path;
+   };
+
+   LexReport lex_files(const std::vector<std::string>& paths, size_t worker_count)
+   {
+      LexReport report;
+      report.files.resize(paths.size());
+
+      for (size_t file_index = 0; file_index < paths.size(); file_index++)
+      {
+         std::error_code error;
+         report.files[file_index].path = paths[file_index];
+         report.files[file_index].size = std::filesystem::file_size(paths[file_index],error);
+      };
+
+      //longest processing time first: big files start early on every worker and the small ones fill the gaps,
+      //so a huge module doesn't end up straggling alone at the end
+      std::vector<size_t> schedule(paths.size());
+      std::iota(schedule.begin(),schedule.end(),0);
+      std::stable_sort(schedule.begin(),schedule.end(),[&](size_t left, size_t right) {
+         return report.files[left].size > report.files[right].size;
+      });
+
+      WorkStealingPool pool(std::min(worker_count,std::max<size_t>(paths.size(),1)));
+      report.worker_count = pool.worker_count();
+
+      //one arena, lexer and token buffer per worker, reset between files so their allocations are reused
+      std::vector<Util::Arena> arenas(pool.worker_count());
+      std::vector<Util::Lexer> lexers;
+      std::vector<std::vector<Util::TokenGeneric>> token_buffers(pool.worker_count());
+
+      lexers.reserve(pool.worker_count());
+      for (auto& arena : arenas)
+      {
+         lexers.emplace_back(arena);
+      };
+
+      for (size_t scheduled = 0; scheduled < schedule.size(); scheduled++)
+      {
+         auto file_index = schedule[scheduled];
+         pool.submit(scheduled,[&,file_index](size_t worker_index) {
+            auto& result = report.files[file_index];
+
+            auto file_input = Util::PaddedSource::from_file(result.path.c_str());
+            if (!file_input)
+            {
+               result.too_large = is_too_large(result.path);
+               return;
+            };
+
+            result.readable = true;
+            result.size = file_input->size();
+
+            auto source = file_input->view();
+            auto& lexer = lexers[worker_index];
+            auto& tokens = token_buffers[worker_index];
+
+            arenas[worker_index].reset();
+            lexer.reset(source);
+            tokens.clear();
+            lexer.tokenize_all(tokens);
+
+            result.token_count = tokens.size();
+            result.error_count = std::count_if(tokens.begin(),tokens.end(),[](const Util::TokenGeneric& token) {
+               return token.token_type == Util::TokenType::Error;
+            });
+         });
+      };
+
+      auto start = std::chrono::steady_clock::now();
+      pool.run();
+      auto end = std::chrono::steady_clock::now();
+
+      report.seconds = std::chrono::duration<double>(end - start).count();
+
+      for (const auto& arena : arenas)
+      {
+         report.arena_high_water_mark = std::max(report.arena_high_water_mark,arena.stats().high_water_mark);
+         report.arena_reserved_bytes += arena.stats().reserved_bytes;
+      };
+
+      for (const auto& result : report.files)
+      {
+         if (!result.readable)
+         {
+            report.unreadable_files++;
+            continue;
+         };
+         report.total_bytes += result.size;
+         report.total_tokens += result.token_count;
+         report.total_errors += result.error_count;
+      };
+
+      return report;
+   };
+
+   LexFileResult lex_standard_input()
+   {
+      LexFileResult result;
+      result.path = "-";
+
+      Util::StreamingLexer streaming_lexer([](void*, unsigned char* destination, size_t capacity) -> long long {
+         auto read_count = std::fread(destination,1,capacity,stdin);
+         if (read_count == 0 && std::ferror(stdin))
+         {
+            return -1;
+         };
+         return static_cast<long long>(read_count);
+      }, nullptr);
+
+      //only one batch of tokens is alive at a time
+      Util::TokenStream tokens;
+      while (streaming_lexer.tokenize_next(tokens))
+      {
+         result.token_count += tokens.size();
+         result.error_count += std::count(tokens.get_types().begin(),tokens.get_types().end(),Util::TokenType::Error);
+         tokens.clear();
+      };
+
+      result.readable = !streaming_lexer.has_failed();
+      result.too_large = streaming_lexer.is_too_large();
+      result.size = streaming_lexer.bytes_read();
+      return result;
+   };
+
+   int run_clua_lex(int argc, char** argv)
+   {
+      size_t worker_count = std::max(std::thread::hardware_concurrency(),1u);
+      std::vector<std::string> paths;
+
+      auto print_usage = []() {
+         std::cerr << "usage: clua-lex [-j N] <files or directories>... | clua-lex -" << std::endl;
+         return 1;
+      };
+
+      for (int argument_index = 0; argument_index < argc; argument_index++)
+      {
+         std::string_view argument = argv[argument_index];
+
+         if (argument == "-j")
+         {
+            if (argument_index + 1 == argc)
+            {
+               return print_usage();
+            };
+
+            //the whole argument has to be a count, "abc" or "4x" are usage errors
+            std::string_view count_text = argv[++argument_index];
+            size_t count = 0;
+            auto [count_end, count_error] = std::from_chars(count_text.data(),count_text.data() + count_text.size(),count);
+            if (count_error != std::errc() || count_end != count_text.data() + count_text.size())
+            {
+               return print_usage();
+            };
+
+            worker_count = std::max<size_t>(count,1);
+            continue;
+         };
+
+         paths.emplace_back(argument);
+      };
+
+      if (paths.size() == 1 && paths.front() == "-")
+      {
+         auto start = std::chrono::steady_clock::now();
+         auto result = lex_standard_input();
+         auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         if (!result.readable)
+         {
+            std::cerr << describe_unreadable("standard input",result.too_large) << std::endl;
+            return 1;
+         };
+
+         std::cout << "bytes: " << result.size
+            << " tokens: " << result.token_count
+            << " errors: " << result.error_count
+            << " time: " << seconds * 1000.0 << " ms" << std::endl;
+         return 0;
+      };
+
+      auto files = collect_clua_files(paths);
+
+      if (files.empty())
+      {
+         return print_usage();
+      };
+
+      auto report = lex_files(files,worker_count);
+
+      for (const auto& result : report.files)
+      {
+         if (!result.readable)
+         {
+            std::cerr << describe_unreadable(result.path,result.too_large) << std::endl;
+         } else if (result.error_count > 0)
+         {
+            std::cout << result.path << ": " << result.error_count << " error token(s)" << std::endl;
+         };
+      };
+
+      std::cout << "files: " << report.files.size() - report.unreadable_files
+         << " bytes: " << report.total_bytes
+         << " tokens: " << report.total_tokens
+         << " errors: " << report.total_errors
+         << " workers: " << report.worker_count << std::endl;
+
+      std::cout << "time: " << report.seconds * 1000.0 << " ms, "
+         << report.tokens_per_second() << " tokens/s, "
+         << report.megabytes_per_second() << " MB/s" << std::endl;
+
+      std::cout << "arena: " << report.arena_high_water_mark << " bytes high-water mark, "
+         << report.arena_reserved_bytes << " bytes reserved" << std::endl;
+
+      return report.unreadable_files == 0 ? 0 : 1;
+   };
+}
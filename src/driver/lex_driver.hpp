@@ -0,0 +1,59 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Driver {
+
+    struct LexFileResult {
+        std::string path;
+        size_t size = 0;
+        size_t token_count = 0;
+        size_t error_count = 0;
+        bool readable = false;
+        bool too_large = false; //not readable because it is past Util::max_source_size
+    };
+
+    struct LexReport {
+        std::vector<LexFileResult> files;
+        size_t worker_count = 0;
+        size_t total_bytes = 0;
+        size_t total_tokens = 0;
+        size_t total_errors = 0;
+        size_t unreadable_files = 0;
+        size_t arena_high_water_mark = 0; //largest per worker arena usage for a single file
+        size_t arena_reserved_bytes = 0;  //summed over all workers
+        double seconds = 0;
+
+        inline double tokens_per_second() const
+        {
+            return seconds > 0 ? total_tokens / seconds : 0;
+        };
+
+        inline double megabytes_per_second() const
+        {
+            return seconds > 0 ? total_bytes / seconds / (1024.0 * 1024.0) : 0;
+        };
+    };
+
+    //whether a file from_file refused is larger than Util::max_source_size, rather than missing or unreadable
+    bool is_too_large(const std::string& path);
+
+    //the reason a source was not lexed, for the "Could not read" style messages of the drivers
+    std::string describe_unreadable(const std::string& path, bool too_large);
+
+    //files are taken as they are, directories are searched recursively for *.clua
+    std::vector<std::string> collect_clua_files(const std::vector<std::string>& paths);
+
+    //lexes every file on a work-stealing pool with one Lexer per worker, biggest files are scheduled first
+    LexReport lex_files(const std::vector<std::string>& paths, size_t worker_count);
+
+    //streams standard input through a StreamingLexer, so piped code is lexed while it is still being written
+    LexFileResult lex_standard_input();
+
+    //entry for `clua-lex [-j N] <files or directories>...`, a single `-` lexes standard input
+    int run_clua_lex(int argc, char** argv);
+}
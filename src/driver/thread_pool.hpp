@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <functional>
+
+namespace Driver {
+
+    //Batch work-stealing pool: every task is submitted up front into a worker's queue, then run() blocks until all of them ran.
+    //A worker takes from the front of its own queue and, once that is empty, steals from the back of the others.
+    class WorkStealingPool {
+        public:
+        using Task = std::function<void(size_t worker_index)>;
+
+        private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+        bool pop_own(size_t worker_index, Task& task)
+        {
+            auto& queue = *queues[worker_index];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                return false;
+            };
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        };
+
+        bool steal(size_t worker_index, Task& task)
+        {
+            for (size_t offset = 1; offset < queues.size(); offset++)
+            {
+                auto& queue = *queues[(worker_index + offset) % queues.size()];
+                std::lock_guard lock(queue.mutex);
+                if (!queue.tasks.empty())
+                {
+                    task = std::move(queue.tasks.back());
+                    queue.tasks.pop_back();
+                    return true;
+                };
+            };
+            return false;
+        };
+
+        void work(size_t worker_index)
+        {
+            Task task;
+            //no task submits new tasks, so once every queue is empty there is nothing left to wait for
+            while (pop_own(worker_index,task) || steal(worker_index,task))
+            {
+                task(worker_index);
+            };
+        };
+
+        public:
+        explicit WorkStealingPool(size_t worker_count)
+        {
+            if (worker_count == 0)
+            {
+                worker_count = 1;
+            };
+
+            for (size_t worker_index = 0; worker_index < worker_count; worker_index++)
+            {
+                queues.push_back(std::make_unique<WorkerQueue>());
+            };
+        };
+
+        inline size_t worker_count() const noexcept
+        {
+            return queues.size();
+        };
+
+        void submit(size_t worker_index, Task task)
+        {
+            auto& queue = *queues[worker_index % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        };
+
+        void run()
+        {
+            std::vector<std::thread> threads;
+            for (size_t worker_index = 1; worker_index < queues.size(); worker_index++)
+            {
+                threads.emplace_back(&WorkStealingPool::work,this,worker_index);
+            };
+
+            work(0);
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            };
+        };
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <cstring>
+#include <array>
+#include <string_view>
+#include <stdint.h>
 
 #define KEYWORDS \
     Keyword(If, "if") \
@@ -55,34 +57,98 @@ namespace KeywordClassifier {
         Unknown
     };
 
-    Keyword get_keyword_type(const char* keyword)
-    {
-        if (!keyword || !*keyword) return Keyword::Unknown;
+    struct KeywordEntry {
+        std::string_view keyword_string;
+        Keyword keyword;
+    };
 
+    inline constexpr KeywordEntry keyword_entries[] = {
         #define Keyword(KeywordValue, KeywordString) \
-            else if (std::strcmp(keyword, KeywordString) == 0) { \
-                return Keyword::KeywordValue; \
-            }
+            {KeywordString, Keyword::KeywordValue},
             KEYWORDS
         #undef Keyword
+    };
+
+    //Perfect hash over (length, first char, last char), the seed is searched for at compile time
+    //so that no two keywords share a slot. A lookup is then one slot load, a length compare and a single string compare.
+    namespace KeywordTable {
+        inline constexpr size_t table_size = 128;
+        inline constexpr uint8_t empty_slot = 0xFF;
+
+        constexpr size_t hash(size_t length, unsigned char first_char, unsigned char last_char, uint32_t seed)
+        {
+            uint32_t hash_value = first_char * seed + last_char * (seed >> 4 | 1) + static_cast<uint32_t>(length) * 0x9E37u;
+            return (hash_value ^ (hash_value >> 7)) & (table_size - 1);
+        };
+
+        struct Table {
+            uint32_t seed = 0;
+            std::array<uint8_t,table_size> slots {};
+        };
+
+        constexpr bool try_seed(uint32_t seed, Table& table)
+        {
+            table.seed = seed;
+            table.slots.fill(empty_slot);
+
+            for (size_t entry_index = 0; entry_index < std::size(keyword_entries); entry_index++)
+            {
+                auto keyword_string = keyword_entries[entry_index].keyword_string;
+                auto slot = hash(keyword_string.length(), keyword_string.front(), keyword_string.back(), seed);
+
+                if (table.slots[slot] != empty_slot)
+                {
+                    return false;
+                };
+
+                table.slots[slot] = static_cast<uint8_t>(entry_index);
+            };
+
+            return true;
+        };
 
-        else return Keyword::Unknown;
+        constexpr Table build_table()
+        {
+            static_assert(std::size(keyword_entries) < empty_slot, "too many keywords for 8 bit slots");
+
+            Table table;
+            for (uint32_t seed = 1; seed < 0x10000; seed++)
+            {
+                if (try_seed(seed, table))
+                {
+                    return table;
+                };
+            };
+
+            throw "KeywordTable: no collision free seed, grow table_size";
+        };
+
+        inline constexpr Table table = build_table();
     };
 
-    Keyword get_keyword_type(std::string_view keyword)
+    constexpr Keyword get_keyword_type(std::string_view keyword)
     {
         if (keyword.length() == 0) return Keyword::Unknown;
 
-        #define Keyword(KeywordValue, KeywordString) \
-            else if (keyword == KeywordString) { \
-                return Keyword::KeywordValue; \
-            }
-            KEYWORDS
-        #undef Keyword
+        auto slot = KeywordTable::hash(keyword.length(), keyword.front(), keyword.back(), KeywordTable::table.seed);
+        auto entry_index = KeywordTable::table.slots[slot];
+
+        if (entry_index == KeywordTable::empty_slot) return Keyword::Unknown;
+
+        const auto& entry = keyword_entries[entry_index];
+        if (entry.keyword_string != keyword) return Keyword::Unknown;
 
-        else return Keyword::Unknown;
+        return entry.keyword;
     }
 
+    constexpr Keyword get_keyword_type(const char* keyword)
+    {
+        if (!keyword) return Keyword::Unknown;
+        return get_keyword_type(std::string_view(keyword));
+    };
+
+    static_assert(get_keyword_type("static_assert") == Keyword::StaticAssert);
+    static_assert(get_keyword_type("statics") == Keyword::Unknown);
 
     const char* keyword_to_string(Keyword kw)
     {
@@ -0,0 +1,110 @@
+#include <lexer/incremental_lexer.hpp>
+
+namespace Util::IncrementalLexer {
+
+   //number of tokens starting at or before offset, offsets only grow so this is a binary search
+   size_t count_tokens_up_to(const TokenStream& token_stream, size_t offset)
+   {
+      size_t low = 0;
+      size_t high = token_stream.size();
+
+      while (low < high)
+      {
+         auto middle = low + (high - low) / 2;
+         if (token_stream.offset(middle) <= offset)
+         {
+            low = middle + 1;
+         } else {
+            high = middle;
+         };
+      };
+
+      return low;
+   };
+
+   size_t find_restart_token(const TokenStream& old_stream, size_t edit_offset)
+   {
+      if (edit_offset < lookahead)
+      {
+         return 0;
+      };
+
+      for (auto token_index = count_tokens_up_to(old_stream,edit_offset - lookahead); token_index > 0; token_index--)
+      {
+         if (old_stream.flags(token_index - 1) & TokenFlags::Resumable)
+         {
+            return token_index - 1;
+         };
+      };
+
+      return 0;
+   };
+
+   Stats relex(const TokenStream& old_stream, Source new_source, const TextEdit& edit, TokenStream& new_stream, Interner* interner)
+   {
+      Stats stats;
+
+      auto restart = find_restart_token(old_stream,edit.offset);
+
+      new_stream.reserve(new_stream.size() + old_stream.size());
+      for (size_t token_index = 0; token_index < restart; token_index++)
+      {
+         new_stream.push_back_from(old_stream[token_index],old_stream);
+      };
+      stats.reused_prefix_tokens = restart;
+
+      new_source.index = restart < old_stream.size() ? old_stream.offset(restart) : 0;
+      Lexer lexer(new_source);
+      lexer.set_interner(interner);
+
+      auto old_edit_end = edit.offset + edit.removed_length;
+      auto new_edit_end = edit.offset + edit.inserted.size();
+      size_t old_index = restart;
+
+      while (true)
+      {
+         auto token = lexer.process_next_token();
+         new_stream.push_back_from(token,lexer.get_context());
+         stats.relexed_tokens++;
+
+         //past the end of the source the EndOfFile token has been consumed, whatever mode the lexer was left in
+         const auto& context = lexer.get_context();
+         auto position = context.source.index;
+
+         if (token.token_type == TokenType::EndOfFile || position > new_source.size())
+         {
+            return stats;
+         };
+
+         //only the bytes from position on are read from here, behind the edit they are the old ones,
+         //so once both lexers sit there in CLua mode everything that follows is the old stream shifted
+
+         if (position < new_edit_end || context.see_current_consumer_mode() != ConsumerMode::CLua)
+         {
+            continue;
+         };
+
+         auto old_position = position - new_edit_end + old_edit_end;
+         while (old_index < old_stream.size() && old_stream.offset(old_index) < old_position)
+         {
+            old_index++;
+         };
+
+         if (old_index == old_stream.size() || old_stream.offset(old_index) != old_position || !(old_stream.flags(old_index) & TokenFlags::Resumable))
+         {
+            continue;
+         };
+
+         for (auto token_index = old_index; token_index < old_stream.size(); token_index++)
+         {
+            auto old_token = old_stream[token_index];
+            old_token.offset = old_token.offset - old_edit_end + new_edit_end;
+            new_stream.push_back_from(old_token,old_stream);
+         };
+
+         stats.reused_suffix_tokens = old_stream.size() - old_index;
+         stats.resynced = true;
+         return stats;
+      };
+   };
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+
+#include <stdint.h>
+#include <string_view>
+
+namespace Util::IncrementalLexer {
+
+    //bytes [offset, offset + removed_length) of the old text were replaced with inserted
+    struct TextEdit {
+        size_t offset = 0;
+        size_t removed_length = 0;
+        std::string_view inserted;
+    };
+
+    //how far past its end the lexer may have looked to end a token, so tokens ending closer than this to an edit are lexed again
+    constexpr size_t lookahead = 8;
+
+    struct Stats {
+        size_t reused_prefix_tokens = 0;
+        size_t relexed_tokens = 0;
+        size_t reused_suffix_tokens = 0;
+        bool resynced = false; //false when lexing had to run to the end of the file
+    };
+
+    //Produces exactly what Lexer(new_source).tokenize_all(new_stream) would, where new_source is the old text with edit applied
+    //and old_stream its complete token stream. Lexing restarts at the last Resumable token at least lookahead bytes before the edit
+    //and stops as soon as a new token boundary in CLua mode lines up with a Resumable old token behind the edit,
+    //the remaining old tokens are copied with their offsets shifted.
+    //interner has to be the one old_stream was lexed with (null for none), the relexed identifiers get their atoms from it.
+    Stats relex(const TokenStream& old_stream, Source new_source, const TextEdit& edit, TokenStream& new_stream, Interner* interner = nullptr);
+}
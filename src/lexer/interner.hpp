@@ -0,0 +1,188 @@
+#pragma once
+
+#include <DebuggerAssets/debugger/debugger.hpp>
+#include <arena.hpp>
+
+#include <stdint.h>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Util {
+
+    using namespace std::string_literals;
+
+    constexpr auto InternerError = "Intern Error: "s;
+    constexpr auto InternerErrorEnd = "\n"s;
+
+    //the identity of an identifier's text, two tokens lexed with the same Interner have equal atoms exactly when their text is equal
+    using Atom = uint32_t;
+    inline constexpr Atom no_atom = UINT32_MAX;
+
+    //multiply and fold, 8 bytes at a time. The top bits pick the interner shard, the low bits the slot
+    inline uint64_t hash_identifier(const unsigned char* text, size_t length)
+    {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+        uint64_t hash_value = length * multiplier;
+        size_t position = 0;
+
+        for (; position + 8 <= length; position += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word,text + position,8);
+            hash_value = (hash_value ^ word) * multiplier;
+            hash_value ^= hash_value >> 29;
+        };
+
+        if (position < length)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word,text + position,length - position);
+            hash_value = (hash_value ^ word) * multiplier;
+            hash_value ^= hash_value >> 29;
+        };
+
+        hash_value = (hash_value ^ (hash_value >> 32)) * multiplier;
+        return hash_value ^ (hash_value >> 29);
+    };
+
+    inline uint64_t hash_identifier(std::string_view text)
+    {
+        return hash_identifier(reinterpret_cast<const unsigned char*>(text.data()),text.size());
+    };
+
+    //Identifier table shared by every lexer of a compilation, also across threads. The hash picks one of shard_count shards,
+    //each an open addressing table (linear probing, at most half full) with its own lock and its own arena holding the text,
+    //so lexers on different threads rarely wait for each other. An atom is the text's index in its shard with the shard in the
+    //low bits, it and the text behind it stay valid as long as the interner does
+    class Interner {
+        public:
+        static constexpr size_t shard_bits = 4;
+        static constexpr size_t shard_count = size_t(1) << shard_bits;
+
+        private:
+        static constexpr uint32_t empty_entry = UINT32_MAX;
+        static constexpr size_t max_shard_entries = (size_t(1) << (32 - shard_bits)) - 1; //keeps every atom below no_atom
+
+        struct Slot {
+            uint32_t hash_tag = 0; //low half of the hash, compared before the text and enough to rehash
+            uint32_t entry = empty_entry;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            Arena text_arena{16 * 1024};
+            std::vector<std::string_view> texts;
+            std::vector<Slot> slots;
+        };
+
+        std::array<Shard,shard_count> shards;
+
+        static void grow(Shard& shard)
+        {
+            std::vector<Slot> slots(std::max<size_t>(64,shard.slots.size() * 2));
+            auto mask = slots.size() - 1;
+
+            for (const auto& slot : shard.slots)
+            {
+                if (slot.entry == empty_entry)
+                {
+                    continue;
+                };
+
+                auto slot_index = slot.hash_tag & mask;
+                while (slots[slot_index].entry != empty_entry)
+                {
+                    slot_index = (slot_index + 1) & mask;
+                };
+                slots[slot_index] = slot;
+            };
+
+            shard.slots = std::move(slots);
+        };
+
+        public:
+        Interner() = default;
+        Interner(const Interner&) = delete;
+        Interner& operator=(const Interner&) = delete;
+
+        //hash_value has to be hash_identifier(text). no_atom when the text is new and its shard already holds max_shard_entries texts
+        Atom intern(std::string_view text, uint64_t hash_value)
+        {
+            auto shard_index = static_cast<size_t>(hash_value >> (64 - shard_bits));
+            auto hash_tag = static_cast<uint32_t>(hash_value);
+            auto& shard = shards[shard_index];
+
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            if (shard.texts.size() * 2 >= shard.slots.size())
+            {
+                grow(shard);
+            };
+
+            auto mask = shard.slots.size() - 1;
+            for (auto slot_index = hash_tag & mask; ; slot_index = (slot_index + 1) & mask)
+            {
+                auto& slot = shard.slots[slot_index];
+
+                if (slot.entry == empty_entry)
+                {
+                    //atoms are 32 bit, a full shard hands out no_atom for new texts instead of wrapping around
+                    if (shard.texts.size() >= max_shard_entries) [[unlikely]]
+                    {
+                        return no_atom;
+                    };
+
+                    auto stored_text = static_cast<char*>(shard.text_arena.allocate(std::max<size_t>(text.size(),1),1));
+                    std::memcpy(stored_text,text.data(),text.size());
+
+                    slot.hash_tag = hash_tag;
+                    slot.entry = static_cast<uint32_t>(shard.texts.size());
+                    shard.texts.emplace_back(stored_text,text.size());
+
+                    return (slot.entry << shard_bits) | static_cast<Atom>(shard_index);
+                };
+
+                if (slot.hash_tag == hash_tag && shard.texts[slot.entry] == text)
+                {
+                    return (slot.entry << shard_bits) | static_cast<Atom>(shard_index);
+                };
+            };
+        };
+
+        Atom intern(std::string_view text)
+        {
+            return intern(text,hash_identifier(text));
+        };
+
+        std::string_view text(Atom atom)
+        {
+            auto& shard = shards[atom & (shard_count - 1)];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            Assert(
+                (atom >> shard_bits) < shard.texts.size(),
+                InternerError +
+                "atom was not handed out by this interner"s +
+                InternerErrorEnd
+            );
+
+            return shard.texts[atom >> shard_bits];
+        };
+
+        size_t size()
+        {
+            size_t atom_count = 0;
+            for (auto& shard : shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                atom_count += shard.texts.size();
+            };
+            return atom_count;
+        };
+    };
+}
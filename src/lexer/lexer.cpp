@@ -1,7 +1,21 @@
 #include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+#include <lexer/scanner.hpp>
 
 #include <string>
 #include <array>
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <charconv>
+#include <limits>
+
+#if defined(__linux__)
+   #include <fcntl.h>
+   #include <unistd.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+#endif
 
 namespace Util { 
    using namespace std::string_literals;
@@ -137,33 +151,68 @@ namespace Util {
       );
    };
 
-   void consume_numbers_letters(LexerContext& lexer_context)
+   void LexerContext::validate_utf8_window()
    {
-      auto current_char = lexer_context.source.see_current();
-      auto char_type = character_map[current_char]; 
+      auto buffer = source.get_source_buffer();
+      auto window_end = std::min(source.size(),utf8_valid_end + utf8_window_size);
 
-      while (char_type == CharacterType::Numeric || char_type == CharacterType::Letter)
+      //the window has to end between two characters, one cut in half would look truncated
+      if (window_end < source.size())
       {
-         lexer_context.source.consume();
+         auto boundary = window_end;
+         while (boundary > utf8_valid_end && window_end - boundary < 4 && (buffer[boundary] & 0xC0) == 0x80)
+         {
+            boundary--;
+         };
+         if (boundary > utf8_valid_end)
+         {
+            window_end = boundary;
+         };
+      };
 
-         current_char = lexer_context.source.see_current();
-         char_type = character_map[current_char];
+      utf8_valid_end = Scanner::validate_utf8(buffer + utf8_valid_end,buffer + window_end) - buffer;
+      utf8_invalid = utf8_valid_end < window_end;
+   };
+
+   //returns hash_identifier of the consumed run, hashed while its bytes are still in cache.
+   //Non ASCII characters count as letters, validation has vouched for every byte before utf8_valid_end so they are skipped bytewise
+   uint64_t consume_numbers_letters(LexerContext& lexer_context)
+   {
+      auto& source = lexer_context.source;
+      auto buffer = source.get_source_buffer();
+      auto begin = source.current_ptr();
+      auto end = Scanner::skip_identifier(begin,source.end_ptr(),source.readable_end());
+
+      while (end < source.end_ptr() && *end >= 0x80 && lexer_context.is_valid_utf8_until(end - buffer + 1))
+      {
+         auto valid_end = buffer + lexer_context.utf8_valid_end;
+         while (end < valid_end && *end >= 0x80)
+         {
+            end++;
+         };
+         end = Scanner::skip_identifier(end,source.end_ptr(),source.readable_end());
       };
+
+      source.consume_to(end);
+      return hash_identifier(begin,end - begin);
    };
 
    void consume_identifier_token(LexerContext& lexer_context)
    {
       auto current_char = lexer_context.source.see_current();
 
-      test_char_type(current_char,CharacterType::Letter);
+      if (character_map[current_char] != CharacterType::Unicode)
+      {
+         test_char_type(current_char,CharacterType::Letter);
+      };
 
       size_t offset = lexer_context.source.index;
-      consume_numbers_letters(lexer_context);
+      auto hash_value = consume_numbers_letters(lexer_context);
       size_t length = lexer_context.source.index - offset;
    
       std::string_view identifier_view = std::string_view(reinterpret_cast<char*>(lexer_context.source.get_source_buffer() + offset),length);
 
-      lexer_context.record_identifier(identifier_view);
+      lexer_context.record_identifier(identifier_view,hash_value);
    };
 
    void consume_numbers(LexerContext& lexer_context)
@@ -178,6 +227,115 @@ namespace Util {
       };
    };
 
+   //the integer part of a decimal, accumulated while it is scanned
+   void consume_decimal_digits(LexerContext& lexer_context, uint64_t& value, bool& overflowed)
+   {
+      auto current_char = lexer_context.source.see_current();
+      while (character_map[current_char] == CharacterType::Numeric)
+      {
+         uint64_t digit = current_char - '0';
+         overflowed |= value > (UINT64_MAX - digit) / 10;
+         value = value * 10 + digit;
+
+         lexer_context.source.consume();
+         current_char = lexer_context.source.see_current();
+      };
+   };
+
+   //hex and binary literals may be followed by anything a decimal integer may, but not by a '.'
+   inline bool ends_integer_literal(unsigned char end_char)
+   {
+      auto end_char_type = character_map[end_char];
+      return end_char != '.' && (TypeClassificator::is_neutral_char_type(end_char_type) || end_char_type == CharacterType::Symbol);
+   };
+
+   void record_integer(LexerContext& lexer_context, NumberBase number_base, uint64_t value, bool overflowed)
+   {
+      if (overflowed)
+      {
+         return lexer_context.record_error(ErrorCode::NumberOverflow);
+      };
+
+      NumberHint number_hint;
+      number_hint.number_type = NumberType::Integer;
+      number_hint.number_base = number_base;
+      number_hint.integer_value = value;
+      lexer_context.record_number(number_hint);
+   };
+
+   //std::from_chars rounds correctly (libstdc++ runs the Eisel-Lemire fast path and falls back to exact arithmetic).
+   //There is no exponent syntax, so out of range takes hundreds of digits: overflow with an integer part, underflow without one
+   void record_float(LexerContext& lexer_context, size_t start)
+   {
+      auto begin = reinterpret_cast<const char*>(lexer_context.source.get_source_buffer() + start);
+      auto end = reinterpret_cast<const char*>(lexer_context.source.current_ptr());
+
+      NumberHint number_hint;
+      number_hint.number_type = NumberType::Float;
+      number_hint.number_base = NumberBase::Decimal;
+
+      double value = 0;
+      auto [parsed_end, error] = std::from_chars(begin,end,value);
+
+      //digits from the first to the last non zero one, trailing zeros are exact
+      size_t digit_count = 0;
+      size_t first_significant = SIZE_MAX;
+      size_t last_significant = 0;
+      bool has_integer_part = false;
+      bool in_fraction = false;
+
+      for (auto position = begin; position != end; position++)
+      {
+         if (*position == '.')
+         {
+            in_fraction = true;
+            continue;
+         };
+
+         if (*position != '0')
+         {
+            first_significant = std::min(first_significant,digit_count);
+            last_significant = digit_count;
+            has_integer_part |= !in_fraction;
+         };
+         digit_count++;
+      };
+
+      if (error == std::errc::result_out_of_range)
+      {
+         if (has_integer_part)
+         {
+            return lexer_context.record_error(ErrorCode::NumberOverflow);
+         };
+         value = 0;
+         number_hint.flags |= NumberFlags::Underflow;
+      } else if (value != 0 && value < std::numeric_limits<double>::min()) {
+         number_hint.flags |= NumberFlags::Underflow;
+      };
+
+      if (first_significant != SIZE_MAX && last_significant - first_significant + 1 > std::numeric_limits<double>::max_digits10)
+      {
+         number_hint.flags |= NumberFlags::PrecisionLoss;
+      };
+
+      number_hint.float_value = value;
+      lexer_context.record_number(number_hint);
+   };
+
+   //error recovery, a malformed number takes the rest of its word along so 0.0f is one error instead of an error and an identifier
+   void consume_rest_of_word(LexerContext& lexer_context)
+   {
+      auto current_char = lexer_context.source.see_current();
+      auto char_type = character_map[current_char];
+
+      while (char_type == CharacterType::Letter || char_type == CharacterType::Numeric || char_type == CharacterType::Unicode || current_char == '.')
+      {
+         lexer_context.source.consume();
+         current_char = lexer_context.source.see_current();
+         char_type = character_map[current_char];
+      };
+   };
+
    void consume_hex_numeric_token(LexerContext& lexer_context)
    {
       auto current_char = lexer_context.source.see_current();
@@ -194,16 +352,23 @@ namespace Util {
       current_char = lexer_context.source.see_current();
 
       size_t length = 0;
+      uint64_t value = 0;
+      bool overflowed = false;
 
       while (TypeClassificator::is_hex_code(current_char))
       {
+         uint64_t digit = TypeClassificator::is_numeric_char(current_char) ? current_char - '0' : (current_char | 0x20) - 'a' + 10;
+         overflowed |= (value >> 60) != 0;
+         value = value << 4 | digit;
+
          lexer_context.source.consume();
          current_char = lexer_context.source.see_current();
          length++;
       }
 
-      if (!TypeClassificator::is_neutral_char_type(character_map[current_char]))
+      if (!ends_integer_literal(current_char))
       {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       };
 
@@ -212,7 +377,7 @@ namespace Util {
          return lexer_context.record_error(ErrorCode::TruncatedNumberSequence);
       };
 
-      return lexer_context.record_number(NumberBase::Hexdecimal,NumberType::Integer);
+      return record_integer(lexer_context,NumberBase::Hexdecimal,value,overflowed);
    };
 
    void consume_bin_numeric_token(LexerContext& lexer_context)
@@ -231,16 +396,22 @@ namespace Util {
       current_char = lexer_context.source.see_current();
 
       size_t length = 0;
+      uint64_t value = 0;
+      bool overflowed = false;
 
       while (TypeClassificator::is_bin_code(current_char))
       {
+         overflowed |= (value >> 63) != 0;
+         value = value << 1 | static_cast<uint64_t>(current_char - '0');
+
          lexer_context.source.consume();
          current_char = lexer_context.source.see_current();
          length++;
       }
 
-      if (!TypeClassificator::is_neutral_char_type(character_map[current_char]))
+      if (!ends_integer_literal(current_char))
       {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       };
 
@@ -249,11 +420,12 @@ namespace Util {
          return lexer_context.record_error(ErrorCode::TruncatedNumberSequence);
       };
 
-      return lexer_context.record_number(NumberBase::Binary, NumberType::Integer);
+      return record_integer(lexer_context,NumberBase::Binary,value,overflowed);
    }; 
 
    void consume_decimal_numeric_token(LexerContext& lexer_context)
    {
+      auto start = lexer_context.source.index;
       auto current_char = lexer_context.source.see_current();
       auto first_char = current_char;
 
@@ -265,14 +437,17 @@ namespace Util {
 
       if (current_char == '.')
       {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       };
 
-      consume_numbers(lexer_context);
+      uint64_t value = 0;
+      bool overflowed = false;
+      consume_decimal_digits(lexer_context,value,overflowed);
 
       if(first_char == '.')
       {
-         return lexer_context.record_number(NumberBase::Decimal,NumberType::Float);
+         return record_float(lexer_context,start);
       };
 
       auto middle_char = lexer_context.source.see_current();
@@ -286,9 +461,10 @@ namespace Util {
          consume_numbers(lexer_context);
       } else if (TypeClassificator::is_neutral_char_type(middle_char_type) || is_symbol) [[likely]]
       {
-         return lexer_context.record_number(NumberBase::Decimal,NumberType::Integer);
+         return record_integer(lexer_context,NumberBase::Decimal,value,overflowed);
       } 
       else {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       };
 
@@ -299,12 +475,14 @@ namespace Util {
       //float path
       if (end_char == '.')
       {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       }
       else if (TypeClassificator::is_neutral_char_type(end_char_type) || is_end_char_symbol) [[likely]] 
       {
-         return lexer_context.record_number(NumberBase::Decimal,NumberType::Float);
+         return record_float(lexer_context,start);
       } else {
+         consume_rest_of_word(lexer_context);
          return lexer_context.record_error(ErrorCode::MalformedNumber);
       }; 
    }
@@ -337,47 +515,86 @@ namespace Util {
       lexer_context.source.consume();
    };
 
+   //whether the bytes up to end are the start of a well formed sequence that end cuts short
+   bool is_truncated_utf8(const unsigned char* position, const unsigned char* end)
+   {
+      unsigned char completed[4] = { 0, 0x80, 0x80, 0x80 };
+      auto available = std::min<size_t>(end - position,4);
+      std::memcpy(completed,position,available);
+
+      if (available == 1 && (completed[0] == 0xE0 || completed[0] == 0xF0))
+      {
+         completed[1] = 0xA0; //lowest second byte that isn't overlong for both
+      };
+
+      return Scanner::Scalar::utf8_sequence_length(completed,completed + 4) > available;
+   };
+
+   //end of the character at the source's position, a byte and the (at most three) continuation bytes behind it
+   const unsigned char* utf8_sequence_end(const Source& source)
+   {
+      auto position = source.current_ptr();
+      auto sequence_end = position + 1;
+      while (*position >= 0x80 && sequence_end < source.end_ptr() && sequence_end - position < 4 && (*sequence_end & 0xC0) == 0x80)
+      {
+         sequence_end++;
+      };
+      return sequence_end;
+   };
+
    void consume_error_token(LexerContext& lexer_context)
    {
-      lexer_context.record_error(ErrorCode::UnexpectedCharacter);
-      lexer_context.source.consume(); 
+      auto& source = lexer_context.source;
+
+      if (source.see_current() < 0x80)
+      {
+         lexer_context.record_error(ErrorCode::UnexpectedCharacter);
+         source.consume();
+         return;
+      };
+
+      //malformed UTF-8, the lead (or stray continuation) byte and the continuation bytes behind it are one error
+      auto position = source.current_ptr();
+      auto sequence_end = utf8_sequence_end(source);
+
+      lexer_context.record_error(
+         sequence_end == source.end_ptr() && is_truncated_utf8(position,sequence_end) ? ErrorCode::TruncatedUnicodeSequence : ErrorCode::InvalidByte
+      );
+      source.consume_to(sequence_end);
    };
 
    void consume_symbol_token(LexerContext& lexer_context)
    {
       using namespace SymbolClassifier;
       auto current_char = lexer_context.source.see_current();
-      auto char_type = character_map[current_char];
 
       test_char_type(current_char,CharacterType::Symbol);
 
-      auto start = lexer_context.source.index;
-      auto start_ptr = reinterpret_cast<char*>(lexer_context.source.get_source_buffer() + start);
+      auto node = SymbolTrie::root_node;
 
-      auto symbol_kind = SymbolKind::UNKNOWN;
-      
-      while (char_type == CharacterType::Symbol)
+      //maximal munch, one trie step per character
+      while (true)
       {
-         auto length = lexer_context.source.index - start + 1; 
-         auto next_symbol = get_symbol_from_buffer_fragment(start_ptr,length);
-      
-         if (next_symbol == SymbolKind::UNKNOWN)
+         auto next_node = SymbolTrie::advance(node,current_char);
+
+         if (next_node == SymbolTrie::root_node)
          {
-            return lexer_context.record_symbol(symbol_kind);
+            break;
          }
 
-         symbol_kind = next_symbol;
+         node = next_node;
          lexer_context.source.consume();
          current_char = lexer_context.source.see_current();
-         char_type = character_map[current_char];
       }
 
-      if (symbol_kind == SymbolKind::UNKNOWN)
+      if (node == SymbolTrie::root_node)
       {
+         //no symbol starts with this character, step over it so the lexer can't get stuck on it
+         lexer_context.source.consume();
          return lexer_context.record_error(ErrorCode::UnknownSymbol);
       }
 
-      return lexer_context.record_symbol(symbol_kind);
+      return lexer_context.record_symbol(SymbolTrie::kind_of(node));
    };
 
    void consume_whitespace_token(LexerContext& lexer_context)
@@ -386,13 +603,8 @@ namespace Util {
 
       test_char_type(current_char,CharacterType::Whitespace);
 
-      auto char_type = character_map[current_char]; 
-      while (char_type == CharacterType::Whitespace)
-      {
-         lexer_context.source.consume();
-         current_char = lexer_context.source.see_current();
-         char_type = character_map[current_char];
-      };
+      auto& source = lexer_context.source;
+      source.consume_to(Scanner::skip_whitespace(source.current_ptr(),source.end_ptr(),source.readable_end()));
    };
 
    void consume_inline_comment(LexerContext& lexer_context)
@@ -407,12 +619,9 @@ namespace Util {
          "expected inline comment char start, got somethign else"
       );
 
-      auto inline_char = current_char;
-      while (character_map[inline_char] != CharacterType::NewLine && character_map[inline_char] != CharacterType::EndOfFile)
-      {
-         lexer_context.source.consume();
-         inline_char = lexer_context.source.see_current();
-      };
+      //runs up to the new line or a '\0' byte, which the character_map treats as end of file
+      auto& source = lexer_context.source;
+      source.consume_to(Scanner::find_either(source.current_ptr(),source.end_ptr(),source.readable_end(),'\n','\0'));
 
       /*
          if (character_map[inline_char] == CharacterType::EndOfFile)
@@ -438,22 +647,29 @@ namespace Util {
       
       lexer_context.source.consume(2);
 
-      auto inline_char = lexer_context.source.see_current();
+      auto& source = lexer_context.source;
+      auto end = source.end_ptr();
+      auto position = source.current_ptr();
 
-      while (character_map[inline_char] != CharacterType::EndOfFile)
+      while (true)
       {
-         auto next_char = lexer_context.source.peek();
+         position = Scanner::find_either(position,end,source.readable_end(),'*','\0');
 
-         if (inline_char == '*' && next_char == '/')
+         if (position == end || *position == '\0')
          {
-            lexer_context.source.consume(2);
+            break;
+         };
+
+         if (position + 1 < end && position[1] == '/')
+         {
+            source.consume_to(position + 2);
             return;
          };
 
-         lexer_context.source.consume();
-         inline_char = lexer_context.source.see_current();
+         position++;
       };
 
+      source.consume_to(position);
       return lexer_context.record_error(ErrorCode::UnclosedComment);
    };
 
@@ -496,27 +712,68 @@ namespace Util {
          LexerErrorEnd
       )
 
-      do
+      lexer_context.source.consume(); //consume the opening '"'
+
+      while (true)
       {
-         lexer_context.source.consume();
          current_char = lexer_context.source.see_current();
          char_type = character_map[current_char];
-         
-         if (char_type == CharacterType::EndOfFile) [[unlikely]]
+
+         //strings don't span lines, an unclosed one ends at the line end so the next line lexes normally
+         if (char_type == CharacterType::EndOfFile || char_type == CharacterType::NewLine) [[unlikely]]
          {
             return lexer_context.record_error(ErrorCode::UnclosedString);
-         } else if (current_char == '\\') 
+         } else if (current_char == '"')
          {
-            lexer_context.source.consume(); // skip '\'
-            lexer_context.source.consume(); 
-            continue;
-         }
-      } while (current_char != '"');
+            break;
+         };
+
+         lexer_context.source.consume();
+
+         //the escaped character is skipped with the '\', a backslash at the line end doesn't continue the string either
+         if (current_char == '\\')
+         {
+            auto escaped_type = character_map[lexer_context.source.see_current()];
+            if (escaped_type == CharacterType::EndOfFile || escaped_type == CharacterType::NewLine) [[unlikely]]
+            {
+               return lexer_context.record_error(ErrorCode::UnclosedString);
+            };
+            lexer_context.source.consume();
+         };
+      };
       
       lexer_context.source.consume(); //consume '"'      
       return;
    };
 
+   //error recovery for char literals, skips to the closing ' on the same line and tells whether there was one
+   bool consume_rest_of_char(LexerContext& lexer_context)
+   {
+      auto is_line_end = [&lexer_context]() {
+         auto char_type = character_map[lexer_context.source.see_current()];
+         return char_type == CharacterType::NewLine || char_type == CharacterType::EndOfFile;
+      };
+
+      while (lexer_context.source.see_current() != '\'' && !is_line_end())
+      {
+         auto skipped_char = lexer_context.source.see_current();
+         lexer_context.source.consume();
+
+         if (skipped_char == '\\' && !is_line_end())
+         {
+            lexer_context.source.consume();
+         };
+      };
+
+      if (is_line_end())
+      {
+         return false;
+      };
+
+      lexer_context.source.consume(); //closing '
+      return true;
+   };
+
    void consume_char_token(LexerContext& lexer_context) {
       Assert(
          lexer_context.source.see_current() == '\'',
@@ -527,8 +784,13 @@ namespace Util {
 
       lexer_context.source.consume(); 
       auto current_char = lexer_context.source.see_current();
+
+      if (character_map[current_char] == CharacterType::NewLine || character_map[current_char] == CharacterType::EndOfFile) {
+        return lexer_context.record_error(ErrorCode::UnclosedChar);
+      }
       
       if (current_char == '\'') {
+        lexer_context.source.consume();
         return lexer_context.record_error(ErrorCode::InvalidCharCode);
       }
 
@@ -540,6 +802,7 @@ namespace Util {
             escaped == '0' || escaped == '\\' || escaped == '\'') {
             lexer_context.source.consume();
         } else {
+            consume_rest_of_char(lexer_context);
             return lexer_context.record_error(ErrorCode::InvalidCharCode);
         }
       } else {
@@ -547,7 +810,7 @@ namespace Util {
       }
 
       if (lexer_context.source.see_current() != '\'') {
-        return lexer_context.record_error(ErrorCode::UnclosedChar);
+        return lexer_context.record_error(consume_rest_of_char(lexer_context) ? ErrorCode::TooLongChar : ErrorCode::UnclosedChar);
       }
       
       lexer_context.source.consume(); //closing '
@@ -566,6 +829,8 @@ namespace Util {
                return TokenKind<ErrorToken>::value;
             case CharacterType::Letter: 
                return TokenKind<IdentifierToken>::value;
+            case CharacterType::Unicode:
+               return lexer_context.is_valid_utf8_until(lexer_context.source.index + 1) ? TokenKind<IdentifierToken>::value : TokenKind<ErrorToken>::value;
             case CharacterType::Numeric:
                return TokenKind<NumericToken>::value;
             case CharacterType::Symbol:
@@ -743,10 +1008,11 @@ namespace Util {
          return true;
       };
 
+      //a whole character, so no token boundary (and no checkpoint) ever falls inside a UTF-8 sequence
       void consume_unexpected_token(LexerContext& lexer_context)
       {
          lexer_context.record_error(ErrorCode::UnexpectedTokenType);
-         lexer_context.source.consume();
+         lexer_context.source.consume_to(utf8_sequence_end(lexer_context.source));
          return;
       };
 
@@ -850,36 +1116,7 @@ namespace Util {
          lexer_context.source.consume(2);
       };    
 
-      bool process_end_of_lua_block_token(LexerContext& lexer_context,size_t equal_sign_count)
-      {
-         size_t equal_signs_in_row = 0;
-
-         Assert(
-            lexer_context.source.see_current() == ']',
-            LexerError +
-            "assertion broken, expected comment closing character, got something else instead"s +
-            LexerErrorEnd
-         )
-
-         lexer_context.source.consume();
-
-         auto current_char = lexer_context.source.see_current();
-         while (current_char == '=')
-         {
-            equal_signs_in_row++;
-            lexer_context.source.consume();
-            current_char = lexer_context.source.see_current();
-         };
-
-         if (current_char != ']')
-         {
-            return false;
-         }
-
-         lexer_context.source.consume();
-         return equal_signs_in_row == equal_sign_count;
-      };
-
+      //checks the opening bracket without consuming anything unless it really is one, '[' '='*n '['
       bool process_is_lua_block(LexerContext& lexer_context,size_t& equal_sign_count)
       {  
          if (lexer_context.source.see_current() != '[')
@@ -887,41 +1124,34 @@ namespace Util {
             return false;
          };
 
-         while (lexer_context.source.peek(equal_sign_count + 1) == '='){
-            equal_sign_count++;
+         size_t equal_signs_in_row = 0;
+         while (lexer_context.source.peek(equal_signs_in_row + 1) == '=')
+         {
+            equal_signs_in_row++;
          };
 
-         lexer_context.source.consume(equal_sign_count + 1);
-         
-         if (lexer_context.source.see_current() != '[')
+         if (lexer_context.source.peek(equal_signs_in_row + 1) != '[')
          {
             return false;
          };
 
-         lexer_context.source.consume();
+         equal_sign_count = equal_signs_in_row;
+         lexer_context.source.consume(equal_sign_count + 2);
          return true;
       };
 
+      //End of file is left to consume_lua_block, which reports the unclosed block
       void consume_lua_block_token(LexerContext& lexer_context,size_t equal_sign_count)
       {
+         auto& source = lexer_context.source;
+         auto position = Scanner::find_long_bracket_close(source.current_ptr(),source.end_ptr(),source.readable_end(),equal_sign_count);
 
-         auto current_char = lexer_context.source.see_current();
-         auto char_type = character_map[current_char];
-
-         while (char_type != CharacterType::EndOfFile)
+         if (position == source.end_ptr() || *position == '\0')
          {
-            if (current_char == ']' && process_end_of_lua_block_token(lexer_context,equal_sign_count))
-            {
-               return;
-            } else {
-               lexer_context.source.consume();
-            };
-
-            current_char = lexer_context.source.see_current();
-            char_type = character_map[current_char];
+            return source.consume_to(position);
          };
-         
-         return lexer_context.record_error(ErrorCode::UnclosedLuaBlock);
+
+         source.consume_to(position + equal_sign_count + 2);
       };
 
       void consume_lua_basic_string_token(LexerContext& lexer_context)
@@ -972,17 +1202,11 @@ namespace Util {
          };
       };
 
+      //runs up to the new line, a '\0' or the end of the source is left to consume_lua_block which reports the unclosed block
       void consume_lua_inline_comment_token(LexerContext& lexer_context)
       {
-         auto char_type = character_map[lexer_context.source.see_current()];
-         while (char_type != CharacterType::NewLine)
-         {
-            if (char_type == CharacterType::EndOfFile)
-            {
-               return lexer_context.record_error(ErrorCode::UnclosedLuaBlock);
-            };
-            lexer_context.source.consume();
-         };
+         auto& source = lexer_context.source;
+         source.consume_to(Scanner::find_either(source.current_ptr(),source.end_ptr(),source.readable_end(),'\n','\0'));
       };
 
       void consume_lua_comment_token(LexerContext& lexer_context)
@@ -1007,9 +1231,12 @@ namespace Util {
          }
       };
 
+      //everything up to the next stop byte would be classified as Other too, so the whole run is skipped at once
       void consume_lua_other_token(LexerContext& lexer_context)
       {
-         lexer_context.source.consume();
+         auto& source = lexer_context.source;
+         source.consume();
+         source.consume_to(Scanner::skip_luau_code(source.current_ptr(),source.end_ptr(),source.readable_end()));
       };
 
       void consume_l_bracket(LexerContext& lexer_context)
@@ -1128,6 +1355,11 @@ namespace Util {
          case TokenType::Error:
             CLua::get_next_token(lexer_context,TokenType::Error);
             break;
+         case TokenType::EndOfFile:
+            //the file ends before the block's '{', the error is reported once and CLua mode then lexes the EndOfFile token
+            lexer_context.record_error(ErrorCode::UnclosedLuaBlock);
+            lexer_context.switch_consumer_mode(ConsumerMode::CLua);
+            break;
          default:
             consume_unexpected_token(lexer_context);
             break;
@@ -1137,11 +1369,158 @@ namespace Util {
       };
    };
 
+   void PaddedSource::release()
+   {
+      if (!buffer)
+      {
+         return;
+      };
+
+#if defined(__linux__)
+      if (mapped_size != 0)
+      {
+         munmap(buffer,mapped_size);
+         buffer = nullptr;
+         return;
+      };
+#endif
+
+      delete[] buffer;
+      buffer = nullptr;
+   };
+
+   std::optional<PaddedSource> PaddedSource::read_all(long long (*read_chunk)(void* context, unsigned char* destination, size_t capacity), void* context, size_t size_hint)
+   {
+      PaddedSource padded_source;
+
+      size_t capacity = std::max<size_t>(size_hint + 1, 64 * 1024);
+      padded_source.buffer = new unsigned char[capacity + padding];
+
+      while (true)
+      {
+         if (padded_source.source_size == capacity)
+         {
+            auto grown_buffer = new unsigned char[capacity * 2 + padding];
+            std::memcpy(grown_buffer,padded_source.buffer,padded_source.source_size);
+            delete[] padded_source.buffer;
+            padded_source.buffer = grown_buffer;
+            capacity *= 2;
+         };
+
+         auto read_count = read_chunk(context,padded_source.buffer + padded_source.source_size,capacity - padded_source.source_size);
+         if (read_count < 0)
+         {
+            return std::nullopt;
+         };
+         if (read_count == 0)
+         {
+            break;
+         };
+         padded_source.source_size += static_cast<size_t>(read_count);
+
+         if (padded_source.source_size > max_source_size)
+         {
+            return std::nullopt;
+         };
+      };
+
+      std::memset(padded_source.buffer + padded_source.source_size,0,padding);
+      return padded_source;
+   };
+
+   std::optional<PaddedSource> PaddedSource::from_file(const char* path)
+   {
+#if defined(__linux__)
+      int file_descriptor = open(path,O_RDONLY | O_CLOEXEC);
+      if (file_descriptor < 0)
+      {
+         return std::nullopt;
+      };
+
+      struct stat file_stat;
+      if (fstat(file_descriptor,&file_stat) != 0)
+      {
+         close(file_descriptor);
+         return std::nullopt;
+      };
+
+      size_t file_size = static_cast<size_t>(file_stat.st_size);
+
+      if (S_ISREG(file_stat.st_mode) && file_size > max_source_size)
+      {
+         close(file_descriptor);
+         return std::nullopt;
+      };
+
+      if (S_ISREG(file_stat.st_mode) && file_size > 0)
+      {
+         //Reserve zeroed anonymous memory for the file plus padding, then map the file over the front of it.
+         //The tail of the file's last page reads as zero and the pages after it stay anonymous, so the padding costs no copy.
+         size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+         size_t mapped_size = (file_size + padding + page_size - 1) / page_size * page_size;
+
+         void* reserved = mmap(nullptr,mapped_size,PROT_READ,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+         if (reserved != MAP_FAILED)
+         {
+            void* mapped = mmap(reserved,file_size,PROT_READ,MAP_PRIVATE | MAP_FIXED | MAP_POPULATE,file_descriptor,0);
+            if (mapped != MAP_FAILED)
+            {
+               close(file_descriptor);
+               madvise(mapped,file_size,MADV_SEQUENTIAL);
+
+               PaddedSource padded_source;
+               padded_source.buffer = static_cast<unsigned char*>(mapped);
+               padded_source.source_size = file_size;
+               padded_source.mapped_size = mapped_size;
+               return padded_source;
+            };
+            munmap(reserved,mapped_size);
+         };
+      };
+
+      auto padded_source = read_all([](void* context, unsigned char* destination, size_t capacity) -> long long {
+         auto file_descriptor = *static_cast<int*>(context);
+         while (true)
+         {
+            auto read_count = read(file_descriptor,destination,capacity);
+            if (read_count < 0 && errno == EINTR)
+            {
+               continue;
+            };
+            return read_count;
+         };
+      }, &file_descriptor, S_ISREG(file_stat.st_mode) ? file_size : 0);
+
+      close(file_descriptor);
+      return padded_source;
+#else
+      std::FILE* file = std::fopen(path,"rb");
+      if (!file)
+      {
+         return std::nullopt;
+      };
+
+      auto padded_source = read_all([](void* context, unsigned char* destination, size_t capacity) -> long long {
+         auto file = static_cast<std::FILE*>(context);
+         auto read_count = std::fread(destination,1,capacity,file);
+         if (read_count == 0 && std::ferror(file))
+         {
+            return -1;
+         };
+         return static_cast<long long>(read_count);
+      }, file, 0);
+
+      std::fclose(file);
+      return padded_source;
+#endif
+   };
+
    TokenGeneric Lexer::get_next_token()
    {
       auto token_type = TokenType::None;
       
       size_t start = lexer_context.source.index;
+      bool is_resumable = lexer_context.see_current_consumer_mode() == ConsumerMode::CLua;
       
       switch (lexer_context.see_current_consumer_mode())
       {
@@ -1171,11 +1550,222 @@ namespace Util {
 
       size_t end = lexer_context.source.index;
       size_t length = end - start;
+
+      //a token running over malformed UTF-8 (the sequence itself, or a string or comment holding it) is an error,
+      //validation starts over behind it
+      if (end > lexer_context.utf8_valid_end && !lexer_context.is_valid_utf8_until(end)) [[unlikely]]
+      {
+         if (!lexer_context.has_emitted_report())
+         {
+            lexer_context.record_error(ErrorCode::InvalidByte);
+         };
+         lexer_context.restart_utf8_validation(end);
+      };
+
       TokenGeneric token;
       token.token_type = lexer_context.ultimate_token_type;
+      token.flags = is_resumable ? TokenFlags::Resumable : 0;
+      token.payload_index = lexer_context.see_payload_index();
       token.offset = start;
       token.length = length;
 
+      if (token.token_type == TokenType::Error && token.payload_index != no_payload)
+      {
+         lexer_context.errors[token.payload_index].offset = start;
+         lexer_context.errors[token.payload_index].length = length;
+      };
+
       return token;
    };
+
+   //CLua only, in the other modes new lines and comments aren't always trivia and go through get_next_token.
+   //Block comments are left to get_next_token as well, an unclosed one has to come out as an error token
+   uint8_t Lexer::skip_clua_trivia()
+   {
+      auto& source = lexer_context.source;
+      uint8_t flags = 0;
+
+      while (true)
+      {
+         auto current_char = source.see_current();
+
+         switch (character_map[current_char])
+         {
+         case CharacterType::Whitespace:
+            source.consume_to(Scanner::skip_whitespace(source.current_ptr(),source.end_ptr(),source.readable_end()));
+            break;
+         case CharacterType::NewLine:
+            source.consume();
+            flags |= TokenFlags::PrecededByNewLine;
+            break;
+         case CharacterType::Symbol:
+         {
+            if (current_char != '/' || source.peek() != '/')
+            {
+               return flags;
+            };
+
+            auto comment_end = Scanner::find_either(source.current_ptr(),source.end_ptr(),source.readable_end(),'\n','\0');
+
+            //one holding malformed UTF-8 is left to get_next_token, which turns it into an error token
+            if (!lexer_context.is_valid_utf8_until(comment_end - source.get_source_buffer()))
+            {
+               return flags;
+            };
+            source.consume_to(comment_end);
+            break;
+         }
+         default:
+            return flags;
+         };
+      };
+   };
+
+   TokenGeneric Lexer::get_next_significant_token()
+   {
+      uint8_t flags = 0;
+
+      while (true)
+      {
+         if (lexer_context.see_current_consumer_mode() == ConsumerMode::CLua)
+         {
+            flags |= skip_clua_trivia();
+         };
+
+         lexer_context.token_enter();
+         auto token = get_next_token();
+
+         if (!is_trivia(token.token_type))
+         {
+            token.flags |= flags;
+            return token;
+         };
+
+         auto token_text = lexer_context.source.get_source_buffer() + token.offset;
+         if (token.token_type == TokenType::NewLine || (token.token_type == TokenType::Comment && std::memchr(token_text,'\n',token.length)))
+         {
+            flags |= TokenFlags::PrecededByNewLine;
+         };
+      };
+   };
+
+   template <TriviaMode trivia_mode>
+   size_t Lexer::tokenize_all(std::vector<TokenGeneric>& tokens)
+   {
+      auto first_token = tokens.size();
+      auto& source = lexer_context.source;
+
+      //CLua averages a bit over 4 bytes per token, so this mostly avoids regrowing at all
+      tokens.reserve(first_token + (source.size() - std::min(source.index,source.size())) / 4 + 1);
+
+      //past source.size() the EndOfFile token has been consumed already
+      while (source.index <= source.size())
+      {
+         auto token = process_next_token<trivia_mode>();
+         tokens.push_back(token);
+
+         if (token.token_type == TokenType::EndOfFile)
+         {
+            break;
+         };
+      };
+
+      return tokens.size() - first_token;
+   };
+
+   size_t Lexer::reject_oversized_source(TokenStream& token_stream)
+   {
+      auto& source = lexer_context.source;
+
+      TokenGeneric token;
+      token.token_type = TokenType::Error;
+      token.offset = 0;
+      token.length = 0;
+      token.payload_index = static_cast<uint32_t>(lexer_context.errors.size());
+      lexer_context.errors.push_back({ErrorCode::SourceTooLarge,0,0});
+      token_stream.push_back_from(token,lexer_context);
+
+      token.token_type = TokenType::EndOfFile;
+      token.payload_index = no_payload;
+      token_stream.push_back_from(token,lexer_context);
+
+      source.index = source.size() + 1;
+      return 2;
+   };
+
+   template <TriviaMode trivia_mode>
+   size_t Lexer::tokenize_all(TokenStream& token_stream)
+   {
+      return tokenize_until<trivia_mode>(token_stream,SIZE_MAX);
+   };
+
+   template <TriviaMode trivia_mode>
+   size_t Lexer::tokenize_until(TokenStream& token_stream, size_t end_index)
+   {
+      auto first_token = token_stream.size();
+      auto& source = lexer_context.source;
+
+      if (source.size() > max_source_size) [[unlikely]]
+      {
+         return reject_oversized_source(token_stream);
+      };
+
+      auto lexed_end = std::min(end_index,source.size());
+      token_stream.reserve(first_token + (lexed_end - std::min(source.index,lexed_end)) / 4 + 1);
+
+      //past source.size() the EndOfFile token has been consumed already
+      while (source.index < end_index && source.index <= source.size())
+      {
+         auto token = process_next_token<trivia_mode>();
+         token_stream.push_back_from(token,lexer_context);
+
+         if (token.token_type == TokenType::EndOfFile)
+         {
+            break;
+         };
+      };
+
+      return token_stream.size() - first_token;
+   };
+
+   template size_t Lexer::tokenize_all<TriviaMode::Keep>(std::vector<TokenGeneric>& tokens);
+   template size_t Lexer::tokenize_all<TriviaMode::Skip>(std::vector<TokenGeneric>& tokens);
+   template size_t Lexer::tokenize_all<TriviaMode::Keep>(TokenStream& token_stream);
+   template size_t Lexer::tokenize_all<TriviaMode::Skip>(TokenStream& token_stream);
+   template size_t Lexer::tokenize_until<TriviaMode::Keep>(TokenStream& token_stream, size_t end_index);
+   template size_t Lexer::tokenize_until<TriviaMode::Skip>(TokenStream& token_stream, size_t end_index);
+
+   size_t Lexer::tokenize_all(TokenStream& token_stream, std::vector<LexerCheckpoint>& checkpoints, size_t checkpoint_interval)
+   {
+      auto first_token = token_stream.size();
+      auto& source = lexer_context.source;
+      auto next_checkpoint = source.index;
+
+      if (source.size() > max_source_size) [[unlikely]]
+      {
+         return reject_oversized_source(token_stream);
+      };
+
+      checkpoint_interval = std::max<size_t>(checkpoint_interval,1);
+
+      while (source.index <= source.size())
+      {
+         if (source.index >= next_checkpoint)
+         {
+            checkpoints.push_back(lexer_context.save());
+            next_checkpoint = source.index + checkpoint_interval;
+         };
+
+         lexer_context.token_enter();
+         auto token = get_next_token();
+         token_stream.push_back_from(token,lexer_context);
+
+         if (token.token_type == TokenType::EndOfFile)
+         {
+            break;
+         };
+      };
+
+      return token_stream.size() - first_token;
+   };
 }
\ No newline at end of file
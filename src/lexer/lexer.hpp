@@ -3,11 +3,19 @@
 #include <DebuggerAssets/debugger/debugger.hpp>
 #include <symbol_classifier.hpp>
 #include <keyword_classifier.hpp>
+#include <arena.hpp>
+#include <lexer/interner.hpp>
 
 #include <stdint.h>
 #include <vector>
+#include <optional>
+#include <cstring>
+#include <string_view>
+#include <algorithm>
 #include <type_traits>
 #include <concepts>
+#include <iterator>
+#include <ranges>
 
 namespace Util {
 
@@ -31,6 +39,8 @@ namespace Util {
         InvalidCharCode,
         TooLongChar,
         UnclosedLuaBlock,
+        NumberOverflow,
+        SourceTooLarge,
     };
 
     enum class TokenType: uint8_t {
@@ -66,12 +76,24 @@ namespace Util {
         size_t source_size;
     };
 
+    class PaddedSource;
+    class StreamingLexer;
+
     class Source {
+        friend class PaddedSource;
+        friend class StreamingLexer;
+
         public:
         size_t index;
         private:
         size_t source_size;       
         unsigned char* source_buffer;
+        bool padded = false; //at least PaddedSource::padding zero bytes follow source_size, reads there need no bounds check
+
+        Source(unsigned char* source_buffer, size_t source_size, bool padded) : Source(source_buffer, source_size)
+        {
+            this->padded = padded;
+        };
 
         public:
         
@@ -99,7 +121,7 @@ namespace Util {
                 "broken assumption that end_index <= source_size is true"s +
                 LexerErrorEnd
             )
-            return Source(source_buffer + start_index,length);
+            return Source(source_buffer + start_index,length,padded && end_index == source_size);
         };
 
         Source slice(size_t start_index = 0)
@@ -119,6 +141,41 @@ namespace Util {
             return source_buffer;
         };
 
+        inline size_t size() const noexcept
+        {
+            return source_size;
+        };
+
+        inline const unsigned char* current_ptr() const noexcept
+        {
+            return source_buffer + index;
+        };
+
+        inline const unsigned char* end_ptr() const noexcept
+        {
+            return source_buffer + source_size;
+        };
+
+        inline bool is_padded() const noexcept
+        {
+            return padded;
+        };
+
+        //how far vector loads may read, past end_ptr() only when the buffer is padded
+        inline const unsigned char* readable_end() const noexcept;
+
+        //moves index to a position found by scanning from current_ptr()
+        inline void consume_to(const unsigned char* position)
+        {
+            Assert(
+                position >= current_ptr() && position <= end_ptr(),
+                LexerError +
+                "consume_to position is outside of the source_buffer"s +
+                LexerErrorEnd
+            );
+            index = position - source_buffer;
+        };
+
         inline bool can_consume_sentinel(size_t consume_distance = 1)
         {
             //source_size, because the additional character is a null terminator
@@ -149,7 +206,7 @@ namespace Util {
                 "index is reading beyond the source_buffer"s + 
                 LexerErrorEnd
             );
-            if (!can_consume())
+            if (!padded && !can_consume())
             {
                 return '\0';
             };
@@ -174,7 +231,7 @@ namespace Util {
                 "Can't peek here"s + 
                 LexerErrorEnd
             );
-            if (!can_peek())
+            if (!padded && !can_peek(peek_distance))
             {
                 return (unsigned char)'\0';
             };
@@ -182,9 +239,130 @@ namespace Util {
         };
     };
 
+    inline constexpr uint32_t no_payload = UINT32_MAX;
+
+    //token streams store 32 bit offsets, larger sources are refused up front instead of being lexed
+    inline constexpr size_t max_source_size = UINT32_MAX;
+
+    //Owns the input followed by padding zero bytes, so hot loops and vector scans can read
+    //past the end unconditionally and stop on the '\0' (EndOfFile) character class instead.
+    //The bytes either live on the heap or, for regular files opened with from_file, in a private file mapping.
+    class PaddedSource {
+        public:
+        static constexpr size_t padding = 64;
+
+        private:
+        unsigned char* buffer = nullptr;
+        size_t source_size = 0;
+        size_t mapped_size = 0; //non zero when buffer is a file mapping that has to be unmapped instead of deleted
+
+        void release();
+
+        //grows a heap buffer until read_chunk returns 0 (end of input) or a negative value (failure), more than max_source_size bytes fail too
+        static std::optional<PaddedSource> read_all(long long (*read_chunk)(void* context, unsigned char* destination, size_t capacity), void* context, size_t size_hint);
+
+        public:
+        PaddedSource() = default;
+        explicit PaddedSource(size_t source_size) : buffer(new unsigned char[source_size + padding]), source_size(source_size)
+        {
+            std::memset(buffer + source_size, 0, padding);
+        };
+
+        PaddedSource(const unsigned char* source_buffer, size_t source_size) : PaddedSource(source_size)
+        {
+            if (source_size > 0)
+            {
+                std::memcpy(buffer, source_buffer, source_size);
+            };
+        };
+
+        explicit PaddedSource(std::string_view source_text) : PaddedSource(reinterpret_cast<const unsigned char*>(source_text.data()), source_text.size())
+        {};
+
+        PaddedSource(const PaddedSource&) = delete;
+        PaddedSource& operator=(const PaddedSource&) = delete;
+
+        PaddedSource(PaddedSource&& other) noexcept : buffer(other.buffer), source_size(other.source_size), mapped_size(other.mapped_size)
+        {
+            other.buffer = nullptr;
+            other.source_size = 0;
+            other.mapped_size = 0;
+        };
+
+        PaddedSource& operator=(PaddedSource&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                buffer = other.buffer;
+                source_size = other.source_size;
+                mapped_size = other.mapped_size;
+                other.buffer = nullptr;
+                other.source_size = 0;
+                other.mapped_size = 0;
+            };
+            return *this;
+        };
+
+        ~PaddedSource()
+        {
+            release();
+        };
+
+        //Regular files are mapped without copying (on Linux), anything else such as pipes is read into a heap buffer.
+        //Returns nothing when the file can't be opened or read, or is larger than max_source_size.
+        static std::optional<PaddedSource> from_file(const char* path);
+
+        inline unsigned char* data() noexcept
+        {
+            return buffer;
+        };
+
+        inline size_t size() const noexcept
+        {
+            return source_size;
+        };
+
+        inline bool is_mapped() const noexcept
+        {
+            return mapped_size != 0;
+        };
+
+        inline Source view()
+        {
+            Assert(buffer,
+                LexerError +
+                "PaddedSource has no buffer"s +
+                LexerErrorEnd
+            );
+            return Source(buffer, source_size, true);
+        };
+    };
+
+    inline const unsigned char* Source::readable_end() const noexcept
+    {
+        return end_ptr() + (padded ? PaddedSource::padding : 0);
+    };
+
+    namespace TokenFlags {
+        //the token starts in CLua mode, where (offset, mode) is the whole lexer state, so lexing can be resumed from it
+        constexpr uint8_t Resumable = 1 << 0;
+        //set in TriviaMode::Skip when a new line (on its own or inside a block comment) was skipped right before the token
+        constexpr uint8_t PrecededByNewLine = 1 << 1;
+    };
+
+    //Keep emits every token, formatters and editors need the trivia. Skip consumes whitespace, new lines and comments
+    //in the lexer and only returns significant tokens, tagged with TokenFlags::PrecededByNewLine, which is what compiling needs
+    enum class TriviaMode: uint8_t {
+        Keep,
+        Skip
+    };
+
     struct TokenBase
     {
         TokenType token_type = TokenType::Error;
+        uint8_t flags = 0; //TokenFlags
+        uint32_t payload_index = no_payload; //index into the side table of the token's type (errors, numbers, symbols or keywords and atoms)
         size_t length = 0;
         size_t offset = 0;
     };
@@ -321,11 +499,24 @@ namespace Util {
 
     struct Error {
         ErrorCode error_code;
+        size_t offset = 0; //the error token's bytes
+        size_t length = 0;
     };
 
+    namespace NumberFlags {
+        constexpr uint8_t PrecisionLoss = 1 << 0; //more significant digits than a double tells apart, the value is rounded
+        constexpr uint8_t Underflow = 1 << 1;     //not zero, but too small for a normal double
+    };
+
+    //an entry of the constant table, the value is decoded while the literal is lexed
     struct NumberHint {
         NumberType number_type = NumberType::None;
         NumberBase number_base = NumberBase::None;
+        uint8_t flags = 0;
+        union {
+            uint64_t integer_value = 0; //NumberType::Integer
+            double float_value;         //NumberType::Float
+        };
     };
 
     enum class ConsumerMode  {
@@ -344,9 +535,25 @@ namespace Util {
         bool met_first_brace = false;
     };
     
+    //Everything needed to continue lexing from a token boundary. The side tables are only remembered by their sizes,
+    //restoring drops the entries recorded after the checkpoint, so saving one costs a few words instead of four vector copies
+    struct LexerCheckpoint {
+        size_t index = 0;
+        ConsumerMode consumer_mode = ConsumerMode::CLua;
+        LuaUCaptureState luau_capture_state;
+        LuaUCodeState luau_code_state;
+        uint32_t error_count = 0;
+        uint32_t number_count = 0;
+        uint32_t symbol_count = 0;
+        uint32_t keyword_count = 0; //atoms too, identifiers have one entry in each
+    };
+
+    static_assert(std::is_trivially_copyable_v<LexerCheckpoint>, "checkpoints are meant to be copied around freely");
+
     class LexerContext {
         private:
         bool emitted = false;
+        uint32_t payload_index = no_payload;
         ConsumerMode consumer_type = ConsumerMode::CLua;
 
         public:
@@ -355,19 +562,130 @@ namespace Util {
         LuaUCodeState luau_code_state;
 
         Source source;
-        std::vector<Error> errors;
-        std::vector<NumberHint> numbers;
-        std::vector<SymbolClassifier::SymbolKind> symbols;  
-        std::vector<KeywordClassifier::Keyword> keywords;
+        Arena* arena = nullptr; //side tables live here when set, the global heap otherwise
+        ArenaVector<Error> errors;
+        ArenaVector<NumberHint> numbers;
+        ArenaVector<SymbolClassifier::SymbolKind> symbols;
+        ArenaVector<KeywordClassifier::Keyword> keywords;
+        ArenaVector<Atom> atoms; //same index as keywords, no_atom everywhere while there is no interner
+        Interner* interner = nullptr; //shared, it outlives the lexer and is kept across reset()
+
+        //UTF-8 is validated ahead of the lexer a window at a time, every byte from where validation (re)started up to
+        //utf8_valid_end is well formed. utf8_invalid tells a malformed sequence at utf8_valid_end from the end of a window
+        static constexpr size_t utf8_window_size = 16 * 1024;
+        size_t utf8_valid_end = 0;
+        bool utf8_invalid = false;
 
         TokenType ultimate_token_type = TokenType::Error;
         TokenType original_token_type = ultimate_token_type; //this variable is strictly for recover if user chooses to do so
 
         LexerContext() = default;
-        LexerContext(Source& source): source(source)
+        explicit LexerContext(Arena* arena):
+            arena(arena),
+            errors(arena),
+            numbers(arena),
+            symbols(arena),
+            keywords(arena),
+            atoms(arena)
+        {};
+        LexerContext(Source& source, Arena* arena = nullptr):
+            source(source),
+            arena(arena),
+            errors(arena),
+            numbers(arena),
+            symbols(arena),
+            keywords(arena),
+            atoms(arena),
+            utf8_valid_end(source.index)
         {};
 
-        inline ConsumerMode see_current_consumer_mode()
+        //starts over on a new source. Heap side tables keep their capacity, arena side tables start empty again
+        //since the owner is expected to reset the arena between files and their old storage is gone with it
+        inline void reset(Source& new_source)
+        {
+            source = new_source;
+            emitted = false;
+            payload_index = no_payload;
+            switch_consumer_mode(ConsumerMode::CLua);
+            restart_utf8_validation(source.index);
+            if (arena)
+            {
+                errors = ArenaVector<Error>(arena);
+                numbers = ArenaVector<NumberHint>(arena);
+                symbols = ArenaVector<SymbolClassifier::SymbolKind>(arena);
+                keywords = ArenaVector<KeywordClassifier::Keyword>(arena);
+                atoms = ArenaVector<Atom>(arena);
+            } else {
+                errors.clear();
+                numbers.clear();
+                symbols.clear();
+                keywords.clear();
+                atoms.clear();
+            };
+            ultimate_token_type = TokenType::Error;
+            original_token_type = ultimate_token_type;
+        };
+
+        inline LexerCheckpoint save() const
+        {
+            LexerCheckpoint checkpoint;
+            checkpoint.index = source.index;
+            checkpoint.consumer_mode = consumer_type;
+            checkpoint.luau_capture_state = luau_capture_state;
+            checkpoint.luau_code_state = luau_code_state;
+            checkpoint.error_count = static_cast<uint32_t>(errors.size());
+            checkpoint.number_count = static_cast<uint32_t>(numbers.size());
+            checkpoint.symbol_count = static_cast<uint32_t>(symbols.size());
+            checkpoint.keyword_count = static_cast<uint32_t>(keywords.size());
+            return checkpoint;
+        };
+
+        //side tables that are shorter than in the checkpoint (a lexer resuming on another one's checkpoint) are left alone
+        inline void restore(const LexerCheckpoint& checkpoint)
+        {
+            Assert(
+                checkpoint.index <= source.size() + 1,
+                LexerError +
+                "checkpoint lies beyond the end of the source"s +
+                LexerErrorEnd
+            );
+
+            source.index = checkpoint.index;
+            consumer_type = checkpoint.consumer_mode;
+            luau_capture_state = checkpoint.luau_capture_state;
+            luau_code_state = checkpoint.luau_code_state;
+            emitted = false;
+            payload_index = no_payload;
+            restart_utf8_validation(source.index);
+
+            errors.resize(std::min<size_t>(errors.size(),checkpoint.error_count));
+            numbers.resize(std::min<size_t>(numbers.size(),checkpoint.number_count));
+            symbols.resize(std::min<size_t>(symbols.size(),checkpoint.symbol_count));
+            keywords.resize(std::min<size_t>(keywords.size(),checkpoint.keyword_count));
+            atoms.resize(std::min<size_t>(atoms.size(),checkpoint.keyword_count));
+        };
+
+        //whether the source is well formed UTF-8 up to offset, validates further windows when the lexer gets past the checked ones
+        inline bool is_valid_utf8_until(size_t offset)
+        {
+            offset = std::min(offset,source.size());
+            while (utf8_valid_end < offset && !utf8_invalid)
+            {
+                validate_utf8_window();
+            };
+            return utf8_valid_end >= offset;
+        };
+
+        //lexing goes on behind a malformed sequence, so does validation
+        inline void restart_utf8_validation(size_t offset)
+        {
+            utf8_valid_end = offset;
+            utf8_invalid = false;
+        };
+
+        void validate_utf8_window();
+
+        inline ConsumerMode see_current_consumer_mode() const
         {
             return consumer_type;
         };
@@ -382,6 +700,12 @@ namespace Util {
         inline void token_enter()
         {
             emitted = false;
+            payload_index = no_payload;
+        };
+
+        inline uint32_t see_payload_index() const noexcept
+        {
+            return payload_index;
         };
 
         private:
@@ -409,20 +733,18 @@ namespace Util {
 
             Error error;
             error.error_code = error_code;
+            payload_index = static_cast<uint32_t>(errors.size());
             errors.push_back(error);
 
             original_token_type = ultimate_token_type;
             ultimate_token_type = TokenKind<ErrorToken>::value;
         };
 
-        inline void record_number(NumberBase number_base, NumberType number_type)
+        inline void record_number(const NumberHint& number_hint)
         {
             on_emit();
 
-            NumberHint number_hint;
-            number_hint.number_base = number_base;
-            number_hint.number_type = number_type;
-
+            payload_index = static_cast<uint32_t>(numbers.size());
             numbers.push_back(number_hint);
 
             original_token_type = ultimate_token_type;
@@ -433,25 +755,31 @@ namespace Util {
         {
             on_emit();
 
+            payload_index = static_cast<uint32_t>(symbols.size());
             symbols.push_back(symbol);
 
             original_token_type = ultimate_token_type;
             ultimate_token_type = TokenKind<SymbolToken>::value;
         };
 
-        inline void record_identifier(std::string_view identifier)
+        //hash_value is hash_identifier(identifier), taken while the identifier was scanned
+        inline void record_identifier(std::string_view identifier, uint64_t hash_value)
         {
             on_emit();
 
             auto keyword_type = KeywordClassifier::get_keyword_type(identifier);
 
+            payload_index = static_cast<uint32_t>(keywords.size());
             keywords.push_back(keyword_type);
+            atoms.push_back(interner ? interner->intern(identifier,hash_value) : no_atom);
 
             original_token_type = ultimate_token_type;
             ultimate_token_type = TokenKind<IdentifierToken>::value;
         };
     };
 
+    class TokenStream;
+
     class Lexer
     {
         private:
@@ -464,19 +792,181 @@ namespace Util {
             lexer_context = LexerContext(source);
         };
 
+        //side tables are bump allocated from arena, which has to outlive the lexer and must only be reset between files
+        Lexer(Util::Source& source, Arena& arena)
+        {
+            lexer_context = LexerContext(source,&arena);
+        };
+
+        explicit Lexer(Arena& arena)
+        {
+            lexer_context = LexerContext(&arena);
+        };
+
+        //identifier tokens get their atoms from interner from now on, null turns interning off
+        void set_interner(Interner* interner)
+        {
+            lexer_context.interner = interner;
+        };
+
+        //reuses this lexer (and its allocations) for another source
+        void reset(Util::Source& source)
+        {
+            lexer_context.reset(source);
+        };
+
+        //the state before the next token, restoring it lexes the same tokens again, e.g. after a speculative parse
+        LexerCheckpoint save() const
+        {
+            return lexer_context.save();
+        };
+
+        void restore(const LexerCheckpoint& checkpoint)
+        {
+            lexer_context.restore(checkpoint);
+        };
+
+        //continues lexing source from a checkpoint saved by any lexer on the same text
+        void resume(Util::Source& source, const LexerCheckpoint& checkpoint)
+        {
+            lexer_context.reset(source);
+            lexer_context.restore(checkpoint);
+        };
+
         private:
         TokenGeneric get_next_token();
+        uint8_t skip_clua_trivia();
+        TokenGeneric get_next_significant_token();
+        size_t reject_oversized_source(TokenStream& token_stream);
         
         public:
+        template <TriviaMode trivia_mode = TriviaMode::Keep>
         TokenGeneric process_next_token()
         {
-            lexer_context.token_enter();
-            return get_next_token();
+            if constexpr (trivia_mode == TriviaMode::Skip)
+            {
+                return get_next_significant_token();
+            } else {
+                lexer_context.token_enter();
+                return get_next_token();
+            };
+        };
+
+        //lexes everything up to and including the EndOfFile token into tokens, returns how many were appended.
+        //Into a TokenStream a source past max_source_size gives a SourceTooLarge error and the EndOfFile token, both empty at offset 0
+        template <TriviaMode trivia_mode = TriviaMode::Keep>
+        size_t tokenize_all(std::vector<TokenGeneric>& tokens);
+        template <TriviaMode trivia_mode = TriviaMode::Keep>
+        size_t tokenize_all(TokenStream& token_stream);
+
+        //lexes tokens while the next one would start before end_index, stops early after EndOfFile.
+        //The last token may run past end_index, check get_context() for where lexing actually stopped
+        template <TriviaMode trivia_mode = TriviaMode::Keep>
+        size_t tokenize_until(TokenStream& token_stream, size_t end_index);
+
+        //tokenize_all that also saves a checkpoint at the first token boundary past every checkpoint_interval bytes,
+        //so lexing can later be resumed close to any position without starting over from the top
+        size_t tokenize_all(TokenStream& token_stream, std::vector<LexerCheckpoint>& checkpoints, size_t checkpoint_interval);
+
+        const LexerContext& get_context() const
+        {
+            return lexer_context;
         };
 
         const Error get_last_error()
         {
             return lexer_context.errors.back();
         };
+
+        class TokenRange;
+
+        //pulls tokens lazily, the EndOfFile token is the last element
+        TokenRange tokens();
+    };
+
+    inline constexpr bool is_trivia(TokenType token_type)
+    {
+        return token_type == TokenType::Whitespace || token_type == TokenType::NewLine || token_type == TokenType::Comment;
+    };
+
+    //Single pass input iterator over a Lexer, every increment lexes one token. Tokens are only valid until the next increment,
+    //their payloads stay in the lexer's side tables
+    class TokenIterator {
+        private:
+        Lexer* lexer = nullptr;
+        TokenGeneric current;
+        bool past_end = true;
+
+        public:
+        using value_type = TokenGeneric;
+        using difference_type = std::ptrdiff_t;
+        using iterator_concept = std::input_iterator_tag;
+
+        TokenIterator() = default;
+        explicit TokenIterator(Lexer& lexer) : lexer(&lexer), past_end(false)
+        {
+            current = lexer.process_next_token();
+        };
+
+        inline const TokenGeneric& operator*() const noexcept
+        {
+            return current;
+        };
+
+        inline const TokenGeneric* operator->() const noexcept
+        {
+            return &current;
+        };
+
+        //past the end of the source the EndOfFile token has been consumed already, whatever mode the lexer was left in
+        inline TokenIterator& operator++()
+        {
+            if (current.token_type == TokenType::EndOfFile || lexer->get_context().source.index > lexer->get_context().source.size())
+            {
+                past_end = true;
+            } else {
+                current = lexer->process_next_token();
+            };
+            return *this;
+        };
+
+        inline void operator++(int)
+        {
+            ++*this;
+        };
+
+        friend inline bool operator==(const TokenIterator& iterator, std::default_sentinel_t) noexcept
+        {
+            return iterator.past_end;
+        };
+    };
+
+    static_assert(std::input_iterator<TokenIterator>);
+    static_assert(std::sentinel_for<std::default_sentinel_t,TokenIterator>);
+
+    //a view, so it composes with std::views directly: lexer.tokens() | std::views::filter(...)
+    class Lexer::TokenRange : public std::ranges::view_interface<Lexer::TokenRange> {
+        private:
+        Lexer* lexer;
+
+        public:
+        explicit TokenRange(Lexer& lexer) : lexer(&lexer)
+        {};
+
+        //lexes the first token, like any input range it may only be iterated once
+        inline TokenIterator begin() const
+        {
+            return TokenIterator(*lexer);
+        };
+
+        inline std::default_sentinel_t end() const noexcept
+        {
+            return std::default_sentinel;
+        };
+    };
+
+    inline Lexer::TokenRange Lexer::tokens()
+    {
+        return TokenRange(*this);
     };
 }   
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <DebuggerAssets/debugger/debugger.hpp>
+#include <lexer/scanner.hpp>
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+
+namespace Util {
+
+    using namespace std::string_literals;
+
+    constexpr auto LineIndexError = "Line Error: "s;
+    constexpr auto LineIndexErrorEnd = "\n"s;
+
+    //both 1 based, columns count bytes
+    struct SourceLocation {
+        size_t line;
+        size_t column;
+    };
+
+    //Offset to line:column mapping for one source. Tokens only carry offsets and the lexer never looks at line breaks for this,
+    //the index is built on the first lookup: the new lines are counted with the popcount kernel so the start offsets fit in one
+    //exactly sized array of 32 bit offsets, then filled with the new line finder. A lookup is a binary search over it.
+    //Lookups build the index lazily through a const method, so a LineIndex must not be shared between threads before it is built
+    class LineIndex {
+        private:
+        std::string_view source_text;
+        mutable std::vector<uint32_t> line_starts;
+
+        inline void build() const
+        {
+            Assert(
+                source_text.size() <= UINT32_MAX,
+                LineIndexError +
+                "line starts are 32 bit, source is too large"s +
+                LineIndexErrorEnd
+            );
+
+            auto begin = reinterpret_cast<const unsigned char*>(source_text.data());
+            auto end = begin + source_text.size();
+
+            line_starts.reserve(Scanner::count_byte(begin,end,'\n') + 1);
+            line_starts.push_back(0);
+
+            for (auto new_line = Scanner::find_either(begin,end,end,'\n','\n'); new_line < end; new_line = Scanner::find_either(new_line + 1,end,end,'\n','\n'))
+            {
+                line_starts.push_back(static_cast<uint32_t>(new_line + 1 - begin));
+            };
+        };
+
+        inline const std::vector<uint32_t>& starts() const
+        {
+            if (line_starts.empty())
+            {
+                build();
+            };
+            return line_starts;
+        };
+
+        public:
+        LineIndex() = default;
+        explicit LineIndex(std::string_view source_text) : source_text(source_text)
+        {};
+
+        inline bool is_built() const noexcept
+        {
+            return !line_starts.empty();
+        };
+
+        //a source that ends with a new line has an empty last line
+        inline size_t line_count() const
+        {
+            return starts().size();
+        };
+
+        //offsets past the end of the source are clamped to it
+        inline SourceLocation locate(size_t offset) const
+        {
+            const auto& line_starts = starts();
+
+            offset = std::min(offset,source_text.size());
+            auto line = std::upper_bound(line_starts.begin(),line_starts.end(),offset) - line_starts.begin();
+
+            return SourceLocation{static_cast<size_t>(line),offset - line_starts[line - 1] + 1};
+        };
+
+        //offset of the first byte of a 1 based line
+        inline size_t line_start(size_t line) const
+        {
+            Assert(
+                line >= 1 && line <= line_count(),
+                LineIndexError +
+                "line is out of range"s +
+                LineIndexErrorEnd
+            );
+            return starts()[line - 1];
+        };
+
+        //without the new line
+        inline std::string_view line_text(size_t line) const
+        {
+            auto begin = line_start(line);
+            auto end = line < line_count() ? line_start(line + 1) - 1 : source_text.size();
+            return source_text.substr(begin,end - begin);
+        };
+
+        inline size_t memory_bytes() const noexcept
+        {
+            return line_starts.capacity() * sizeof(uint32_t);
+        };
+    };
+}
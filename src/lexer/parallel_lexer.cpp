@@ -0,0 +1,168 @@
+#include <lexer/parallel_lexer.hpp>
+#include <lexer/scanner.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace Util::ParallelLexer {
+
+   namespace SplitPoint {
+      //how many following lines are tried before falling back to the first line after the target
+      constexpr size_t max_candidates = 64;
+
+      bool looks_like_top_level(const unsigned char* line_start, const unsigned char* end)
+      {
+         if (line_start >= end)
+         {
+            return false;
+         };
+
+         auto first_char = *line_start;
+         bool is_letter = ((first_char | 0x20) >= 'a' && (first_char | 0x20) <= 'z') || first_char == '_';
+         bool is_line_comment = first_char == '/' && line_start + 1 < end && line_start[1] == '/';
+
+         return is_letter || first_char == '@' || is_line_comment;
+      };
+   };
+
+   std::vector<size_t> find_split_points(Source source, size_t chunk_count)
+   {
+      std::vector<size_t> split_points;
+
+      auto begin = source.get_source_buffer();
+      auto end = source.end_ptr();
+      auto readable_end = source.readable_end();
+      size_t previous_split = source.index;
+
+      for (size_t chunk_index = 1; chunk_index < chunk_count; chunk_index++)
+      {
+         auto target = std::max(source.size() / chunk_count * chunk_index,previous_split + 1);
+         if (target >= source.size())
+         {
+            break;
+         };
+
+         const unsigned char* fallback = nullptr;
+         const unsigned char* chosen = nullptr;
+         const unsigned char* position = begin + target;
+
+         for (size_t candidate = 0; candidate < SplitPoint::max_candidates; candidate++)
+         {
+            auto new_line = Scanner::find_either(position,end,readable_end,'\n','\n');
+            if (new_line == end)
+            {
+               break;
+            };
+
+            auto line_start = new_line + 1;
+            if (!fallback)
+            {
+               fallback = line_start;
+            };
+
+            if (SplitPoint::looks_like_top_level(line_start,end))
+            {
+               chosen = line_start;
+               break;
+            };
+
+            position = line_start;
+         };
+
+         if (!chosen)
+         {
+            chosen = fallback;
+         };
+
+         if (!chosen || chosen >= end)
+         {
+            break;
+         };
+
+         previous_split = chosen - begin;
+         split_points.push_back(previous_split);
+      };
+
+      return split_points;
+   };
+
+   Stats tokenize(Source source, TokenStream& token_stream, const Options& options)
+   {
+      Stats stats;
+
+      size_t chunk_count = std::min(options.thread_count,source.size() / std::max<size_t>(options.min_chunk_size,1));
+      auto split_points = chunk_count > 1 ? find_split_points(source,chunk_count) : std::vector<size_t>();
+
+      stats.chunk_count = split_points.size() + 1;
+
+      if (split_points.empty())
+      {
+         Lexer lexer(source);
+         lexer.set_interner(options.interner);
+         lexer.tokenize_all(token_stream);
+         return stats;
+      };
+
+      std::vector<size_t> chunk_starts = { source.index };
+      chunk_starts.insert(chunk_starts.end(),split_points.begin(),split_points.end());
+
+      std::vector<Lexer> lexers(stats.chunk_count);
+      std::vector<TokenStream> chunk_streams(stats.chunk_count);
+
+      auto lex_chunk = [&](size_t chunk_index) {
+         Source chunk_source = source;
+         chunk_source.index = chunk_starts[chunk_index];
+
+         auto chunk_end = chunk_index + 1 < chunk_starts.size() ? chunk_starts[chunk_index + 1] : SIZE_MAX;
+
+         lexers[chunk_index].set_interner(options.interner);
+         lexers[chunk_index].reset(chunk_source);
+         lexers[chunk_index].tokenize_until(chunk_streams[chunk_index],chunk_end);
+      };
+
+      std::vector<std::thread> threads;
+      for (size_t chunk_index = 1; chunk_index < stats.chunk_count; chunk_index++)
+      {
+         threads.emplace_back(lex_chunk,chunk_index);
+      };
+      lex_chunk(0);
+
+      for (auto& thread : threads)
+      {
+         thread.join();
+      };
+
+      //stitch: a speculative chunk is exact when the lexer before it ended on its start in CLua mode,
+      //otherwise keep that lexer going through the chunk, it carries the real state across the split
+      token_stream.append(chunk_streams[0]);
+      size_t carrier = 0;
+
+      for (size_t chunk_index = 1; chunk_index < stats.chunk_count; chunk_index++)
+      {
+         //a '\0' ends the input early, nothing after its EndOfFile token belongs to the stream
+         if (token_stream.type(token_stream.size() - 1) == TokenType::EndOfFile)
+         {
+            break;
+         };
+
+         const auto& carrier_context = lexers[carrier].get_context();
+         bool speculation_holds =
+            carrier_context.source.index == chunk_starts[chunk_index] &&
+            carrier_context.see_current_consumer_mode() == ConsumerMode::CLua;
+
+         if (speculation_holds) [[likely]]
+         {
+            token_stream.append(chunk_streams[chunk_index]);
+            carrier = chunk_index;
+            continue;
+         };
+
+         stats.relexed_chunks++;
+
+         auto chunk_end = chunk_index + 1 < chunk_starts.size() ? chunk_starts[chunk_index + 1] : SIZE_MAX;
+         lexers[carrier].tokenize_until(token_stream,chunk_end);
+      };
+
+      return stats;
+   };
+}
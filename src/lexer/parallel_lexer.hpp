@@ -0,0 +1,29 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+
+#include <stdint.h>
+#include <vector>
+
+namespace Util::ParallelLexer {
+
+    struct Options {
+        size_t thread_count = 1;
+        size_t min_chunk_size = 256 * 1024; //smaller inputs aren't worth a thread
+        Interner* interner = nullptr; //shared by the chunk lexers, its shards keep them from queueing up on one lock
+    };
+
+    struct Stats {
+        size_t chunk_count = 0;
+        size_t relexed_chunks = 0; //chunks whose split point turned out to be inside a token and were lexed again sequentially
+    };
+
+    //Picks up to chunk_count - 1 split points, each one the start of a line that looks like top level CLua code
+    //(not indented, so most likely outside of comments, strings and @LUA bodies). Nothing is guaranteed, tokenize verifies them.
+    std::vector<size_t> find_split_points(Source source, size_t chunk_count);
+
+    //Produces exactly what Lexer(source).tokenize_all(token_stream) would, lexing the chunks between split points concurrently.
+    //A chunk is only kept when the lexer of the chunk before it stopped exactly on its split point in CLua mode.
+    Stats tokenize(Source source, TokenStream& token_stream, const Options& options);
+}
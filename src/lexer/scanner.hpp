@@ -0,0 +1,715 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CLUA_SCANNER_X86 1
+    #include <immintrin.h>
+#else
+    #define CLUA_SCANNER_X86 0
+#endif
+
+//Run scanners for the lexer's hot loops. Every function returns the first position in [begin, end)
+//that stops the run, or end. Vector blocks are loaded while they fit below readable_end, which is end
+//for plain buffers and end + PaddedSource::padding for padded ones, so padded input never hits the scalar tail.
+namespace Util::Scanner {
+
+    namespace Scalar {
+        inline bool is_identifier_byte(unsigned char current_char)
+        {
+            return (current_char >= '0' && current_char <= '9') || ((current_char | 0x20) >= 'a' && (current_char | 0x20) <= 'z') || current_char == '_';
+        };
+
+        inline bool is_whitespace_byte(unsigned char current_char)
+        {
+            return current_char == ' ' || current_char == '\t' || current_char == '\r';
+        };
+
+        inline const unsigned char* skip_identifier(const unsigned char* begin, const unsigned char* end)
+        {
+            while (begin < end && is_identifier_byte(*begin)) begin++;
+            return begin;
+        };
+
+        inline const unsigned char* skip_whitespace(const unsigned char* begin, const unsigned char* end)
+        {
+            while (begin < end && is_whitespace_byte(*begin)) begin++;
+            return begin;
+        };
+
+        inline const unsigned char* find_either(const unsigned char* begin, const unsigned char* end, unsigned char first, unsigned char second)
+        {
+            while (begin < end && *begin != first && *begin != second) begin++;
+            return begin;
+        };
+
+        inline size_t count_byte(const unsigned char* begin, const unsigned char* end, unsigned char byte)
+        {
+            size_t count = 0;
+            for (; begin < end; begin++) count += *begin == byte;
+            return count;
+        };
+
+        //bytes the LuaU block state machine has to look at: braces, string and comment starts, '\0' and control bytes
+        //the lexer rejects (everything below ' ' except '\t', '\n' and '\r', and DEL)
+        constexpr bool is_luau_stop_byte(unsigned char current_char)
+        {
+            switch (current_char)
+            {
+            case '{': case '}': case '"': case '\'': case '`': case '[': case '-': case 0x7F:
+                return true;
+            case '\t': case '\n': case '\r':
+                return false;
+            default:
+                return current_char < ' ';
+            };
+        };
+
+        inline const unsigned char* skip_luau_code(const unsigned char* begin, const unsigned char* end)
+        {
+            while (begin < end && !is_luau_stop_byte(*begin)) begin++;
+            return begin;
+        };
+
+        //']' '='*level ']' at position. Only the '=' run right after this ']' is read, so checking every ']' stays linear
+        inline bool is_long_bracket_close(const unsigned char* position, const unsigned char* end, size_t level)
+        {
+            if (static_cast<size_t>(end - position) < level + 2 || position[level + 1] != ']')
+            {
+                return false;
+            };
+            for (size_t equal_sign = 1; equal_sign <= level; equal_sign++)
+            {
+                if (position[equal_sign] != '=')
+                {
+                    return false;
+                };
+            };
+            return true;
+        };
+
+        inline const unsigned char* find_long_bracket_close(const unsigned char* begin, const unsigned char* end, size_t level)
+        {
+            for (; begin < end; begin++)
+            {
+                if (*begin == '\0' || (*begin == ']' && is_long_bracket_close(begin,end,level)))
+                {
+                    return begin;
+                };
+            };
+            return end;
+        };
+
+        //length of the well formed UTF-8 sequence at position (RFC 3629: no overlongs, no surrogates, nothing past U+10FFFF), 0 if it isn't one
+        inline size_t utf8_sequence_length(const unsigned char* position, const unsigned char* end)
+        {
+            auto lead = position[0];
+            auto available = end - position;
+
+            auto is_continuation = [position](size_t byte_index, unsigned char low = 0x80, unsigned char high = 0xBF) {
+                return position[byte_index] >= low && position[byte_index] <= high;
+            };
+
+            if (lead < 0x80)
+            {
+                return 1;
+            };
+            if (lead >= 0xC2 && lead <= 0xDF)
+            {
+                return available >= 2 && is_continuation(1) ? 2 : 0;
+            };
+            if (lead >= 0xE0 && lead <= 0xEF)
+            {
+                auto low = lead == 0xE0 ? 0xA0 : 0x80;
+                auto high = lead == 0xED ? 0x9F : 0xBF;
+                return available >= 3 && is_continuation(1,low,high) && is_continuation(2) ? 3 : 0;
+            };
+            if (lead >= 0xF0 && lead <= 0xF4)
+            {
+                auto low = lead == 0xF0 ? 0x90 : 0x80;
+                auto high = lead == 0xF4 ? 0x8F : 0xBF;
+                return available >= 4 && is_continuation(1,low,high) && is_continuation(2) && is_continuation(3) ? 4 : 0;
+            };
+            return 0;
+        };
+
+        //first byte of [begin, end) that doesn't start a well formed sequence, ASCII is skipped 8 bytes at a time
+        inline const unsigned char* validate_utf8(const unsigned char* begin, const unsigned char* end)
+        {
+            while (begin < end)
+            {
+                uint64_t word;
+                if (end - begin >= 8 && (memcpy(&word,begin,8), (word & 0x8080808080808080ull) == 0))
+                {
+                    begin += 8;
+                    continue;
+                };
+
+                auto length = utf8_sequence_length(begin,end);
+                if (length == 0)
+                {
+                    return begin;
+                };
+                begin += length;
+            };
+            return end;
+        };
+    };
+
+    //Byte set classifier for the LuaU stop bytes: a byte is in the set when the entries for its low and its high nibble
+    //share a bit. Every bit is one group of stop bytes with a common high nibble, checked against the scalar set below.
+    namespace LuaUByteSet {
+        constexpr uint8_t control_0 = 1 << 0; //0x00 - 0x0F without '\t', '\n' and '\r'
+        constexpr uint8_t control_1 = 1 << 1; //0x10 - 0x1F
+        constexpr uint8_t quotes_dash = 1 << 2; //'"' '\'' '-'
+        constexpr uint8_t bracket = 1 << 3; //'['
+        constexpr uint8_t backtick = 1 << 4; //'`'
+        constexpr uint8_t braces_del = 1 << 5; //'{' '}' DEL
+
+        constexpr uint8_t low_nibble[16] = {
+            control_0 | control_1 | backtick,      //0
+            control_0 | control_1,                 //1
+            control_0 | control_1 | quotes_dash,   //2
+            control_0 | control_1,                 //3
+            control_0 | control_1,                 //4
+            control_0 | control_1,                 //5
+            control_0 | control_1,                 //6
+            control_0 | control_1 | quotes_dash,   //7
+            control_0 | control_1,                 //8
+            control_1,                             //9 '\t'
+            control_1,                             //A '\n'
+            control_0 | control_1 | bracket | braces_del, //B
+            control_0 | control_1,                 //C
+            control_1 | quotes_dash | braces_del,  //D '\r'
+            control_0 | control_1,                 //E
+            control_0 | control_1 | braces_del,    //F
+        };
+
+        constexpr uint8_t high_nibble[16] = {
+            control_0, control_1, quotes_dash, 0, 0, bracket, backtick, braces_del,
+            0, 0, 0, 0, 0, 0, 0, 0
+        };
+
+        constexpr bool matches_scalar_set()
+        {
+            for (int char_code = 0; char_code < 256; char_code++)
+            {
+                bool in_set = (low_nibble[char_code & 0x0F] & high_nibble[char_code >> 4]) != 0;
+                if (in_set != Scalar::is_luau_stop_byte(static_cast<unsigned char>(char_code)))
+                {
+                    return false;
+                };
+            };
+            return true;
+        };
+
+        static_assert(matches_scalar_set(), "LuaU nibble tables disagree with is_luau_stop_byte");
+    };
+
+    //a hit inside the padding means the run reached the end of the source
+    inline const unsigned char* clamp(const unsigned char* position, const unsigned char* end)
+    {
+        return position < end ? position : end;
+    };
+
+#if CLUA_SCANNER_X86
+    inline int first_set_bit(uint32_t mask)
+    {
+        return __builtin_ctz(mask);
+    };
+
+    namespace SSE2 {
+        //[0-9A-Za-z_], letters are case folded with | 0x20 which maps nothing else into 'a'..'z'
+        inline __m128i identifier_mask(__m128i block)
+        {
+            auto digits = _mm_sub_epi8(block,_mm_set1_epi8('0'));
+            auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits,_mm_set1_epi8(9)),digits);
+
+            auto letters = _mm_sub_epi8(_mm_or_si128(block,_mm_set1_epi8(0x20)),_mm_set1_epi8('a'));
+            auto is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letters,_mm_set1_epi8(25)),letters);
+
+            auto is_underscore = _mm_cmpeq_epi8(block,_mm_set1_epi8('_'));
+
+            return _mm_or_si128(_mm_or_si128(is_digit,is_letter),is_underscore);
+        };
+
+        inline __m128i whitespace_mask(__m128i block)
+        {
+            return _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block,_mm_set1_epi8(' ')),_mm_cmpeq_epi8(block,_mm_set1_epi8('\t'))),
+                _mm_cmpeq_epi8(block,_mm_set1_epi8('\r'))
+            );
+        };
+
+        inline const unsigned char* skip_identifier(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+        {
+            while (begin < end && readable_end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t stop_mask = ~_mm_movemask_epi8(identifier_mask(block)) & 0xFFFF;
+                if (stop_mask)
+                {
+                    return clamp(begin + first_set_bit(stop_mask),end);
+                };
+                begin += 16;
+            };
+            return begin < end ? Scalar::skip_identifier(begin,end) : end;
+        };
+
+        inline const unsigned char* skip_whitespace(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+        {
+            while (begin < end && readable_end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t stop_mask = ~_mm_movemask_epi8(whitespace_mask(block)) & 0xFFFF;
+                if (stop_mask)
+                {
+                    return clamp(begin + first_set_bit(stop_mask),end);
+                };
+                begin += 16;
+            };
+            return begin < end ? Scalar::skip_whitespace(begin,end) : end;
+        };
+
+        //a popcount of the compare mask per block, only [begin, end) is read
+        inline size_t count_byte(const unsigned char* begin, const unsigned char* end, unsigned char byte)
+        {
+            auto byte_block = _mm_set1_epi8(static_cast<char>(byte));
+            size_t count = 0;
+            while (end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block,byte_block)));
+                begin += 16;
+            };
+            return count + Scalar::count_byte(begin,end,byte);
+        };
+
+        //no byte shuffle for the lookup validation, ASCII blocks are skipped whole and everything else is checked one sequence at a time
+        inline const unsigned char* validate_utf8(const unsigned char* begin, const unsigned char* end)
+        {
+            while (end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t non_ascii_mask = _mm_movemask_epi8(block);
+                if (!non_ascii_mask)
+                {
+                    begin += 16;
+                    continue;
+                };
+
+                begin += first_set_bit(non_ascii_mask);
+                auto length = Scalar::utf8_sequence_length(begin,end);
+                if (length == 0)
+                {
+                    return begin;
+                };
+                begin += length;
+            };
+            return Scalar::validate_utf8(begin,end);
+        };
+
+        inline const unsigned char* find_either(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, unsigned char first, unsigned char second)
+        {
+            auto first_block = _mm_set1_epi8(static_cast<char>(first));
+            auto second_block = _mm_set1_epi8(static_cast<char>(second));
+            while (begin < end && readable_end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t found_mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block,first_block),_mm_cmpeq_epi8(block,second_block)));
+                if (found_mask)
+                {
+                    return clamp(begin + first_set_bit(found_mask),end);
+                };
+                begin += 16;
+            };
+            return begin < end ? Scalar::find_either(begin,end,first,second) : end;
+        };
+
+        //no byte shuffle in SSE2, so the set is compared directly: the characters one by one, control bytes as a range
+        inline __m128i luau_stop_mask(__m128i block)
+        {
+            auto is_control = _mm_cmpeq_epi8(_mm_min_epu8(block,_mm_set1_epi8(0x1F)),block);
+            auto is_allowed_control = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block,_mm_set1_epi8('\t')),_mm_cmpeq_epi8(block,_mm_set1_epi8('\n'))),
+                _mm_cmpeq_epi8(block,_mm_set1_epi8('\r'))
+            );
+
+            auto is_brace = _mm_or_si128(_mm_cmpeq_epi8(block,_mm_set1_epi8('{')),_mm_cmpeq_epi8(block,_mm_set1_epi8('}')));
+            auto is_quote = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block,_mm_set1_epi8('"')),_mm_cmpeq_epi8(block,_mm_set1_epi8('\''))),
+                _mm_cmpeq_epi8(block,_mm_set1_epi8('`'))
+            );
+            auto is_other = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(block,_mm_set1_epi8('[')),_mm_cmpeq_epi8(block,_mm_set1_epi8('-'))),
+                _mm_cmpeq_epi8(block,_mm_set1_epi8(0x7F))
+            );
+
+            return _mm_or_si128(_mm_andnot_si128(is_allowed_control,is_control),_mm_or_si128(_mm_or_si128(is_brace,is_quote),is_other));
+        };
+
+        inline const unsigned char* skip_luau_code(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+        {
+            while (begin < end && readable_end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t stop_mask = _mm_movemask_epi8(luau_stop_mask(block));
+                if (stop_mask)
+                {
+                    return clamp(begin + first_set_bit(stop_mask),end);
+                };
+                begin += 16;
+            };
+            return begin < end ? Scalar::skip_luau_code(begin,end) : end;
+        };
+
+        //every ']' of a block is checked from the bit mask, the next block is only loaded once they all failed
+        inline const unsigned char* find_long_bracket_close(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, size_t level)
+        {
+            auto bracket_block = _mm_set1_epi8(']');
+            while (begin < end && readable_end - begin >= 16)
+            {
+                auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                uint32_t found_mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block,bracket_block),_mm_cmpeq_epi8(block,_mm_setzero_si128())));
+                while (found_mask)
+                {
+                    auto position = begin + first_set_bit(found_mask);
+                    if (position >= end || *position == '\0' || Scalar::is_long_bracket_close(position,end,level))
+                    {
+                        return clamp(position,end);
+                    };
+                    found_mask &= found_mask - 1;
+                };
+                begin += 16;
+            };
+            return begin < end ? Scalar::find_long_bracket_close(begin,end,level) : end;
+        };
+    };
+
+    namespace AVX2 {
+        //two compare masks make one 64 bit popcount
+        __attribute__((target("avx2,popcnt")))
+        inline size_t count_byte(const unsigned char* begin, const unsigned char* end, unsigned char byte)
+        {
+            auto byte_block = _mm256_set1_epi8(static_cast<char>(byte));
+            size_t count = 0;
+            while (end - begin >= 64)
+            {
+                uint64_t low_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin)),byte_block)));
+                uint64_t high_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 32)),byte_block)));
+                count += _mm_popcnt_u64(low_mask | (high_mask << 32));
+                begin += 64;
+            };
+            return count + SSE2::count_byte(begin,end,byte);
+        };
+
+        //Keiser and Lemire's lookup validation (as in simdjson and simdutf): every byte pair is classified by three nibble lookups,
+        //the high and low nibble of the previous byte and the high nibble of the current one, and their and is the set of errors
+        //the pair makes. Continuations of 3 and 4 byte sequences are checked against two and three bytes back separately
+        namespace Utf8 {
+            constexpr uint8_t too_short = 1 << 0;  //lead followed by a lead or ASCII
+            constexpr uint8_t too_long = 1 << 1;   //ASCII followed by a continuation
+            constexpr uint8_t overlong_3 = 1 << 2;
+            constexpr uint8_t too_large = 1 << 3;
+            constexpr uint8_t surrogate = 1 << 4;
+            constexpr uint8_t overlong_2 = 1 << 5;
+            constexpr uint8_t too_large_1000 = 1 << 6;
+            constexpr uint8_t overlong_4 = 1 << 6;
+            constexpr uint8_t two_continuations = 1 << 7;
+            constexpr uint8_t carry = too_short | too_long | two_continuations;
+
+            alignas(16) constexpr uint8_t first_high_nibble[16] = {
+                too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+                two_continuations, two_continuations, two_continuations, two_continuations,
+                too_short | overlong_2,
+                too_short,
+                too_short | overlong_3 | surrogate,
+                too_short | too_large | too_large_1000 | overlong_4,
+            };
+
+            alignas(16) constexpr uint8_t first_low_nibble[16] = {
+                carry | overlong_3 | overlong_2 | overlong_4,
+                carry | overlong_2,
+                carry,
+                carry,
+                carry | too_large,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000 | surrogate,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+            };
+
+            alignas(16) constexpr uint8_t second_high_nibble[16] = {
+                too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+                too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+                too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+                too_long | overlong_2 | two_continuations | surrogate | too_large,
+                too_long | overlong_2 | two_continuations | surrogate | too_large,
+                too_short, too_short, too_short, too_short,
+            };
+
+            //a lead in the last three bytes whose sequence doesn't fit in them
+            alignas(32) constexpr uint8_t incomplete_limits[32] = {
+                255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+                255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+            };
+        };
+
+        //the block shifted back by count bytes, with the last bytes of previous shifted in
+        template <int count>
+        __attribute__((target("avx2")))
+        inline __m256i previous_bytes(__m256i block, __m256i previous)
+        {
+            return _mm256_alignr_epi8(block,_mm256_permute2x128_si256(previous,block,0x21),16 - count);
+        };
+
+        __attribute__((target("avx2")))
+        inline __m256i lookup(const uint8_t* table, __m256i nibbles)
+        {
+            return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(table))),nibbles);
+        };
+
+        __attribute__((target("avx2")))
+        inline __m256i utf8_block_errors(__m256i block, __m256i previous)
+        {
+            auto nibble_mask = _mm256_set1_epi8(0x0F);
+
+            auto previous_1 = previous_bytes<1>(block,previous);
+            auto special_cases = _mm256_and_si256(
+                _mm256_and_si256(
+                    lookup(Utf8::first_high_nibble,_mm256_and_si256(_mm256_srli_epi16(previous_1,4),nibble_mask)),
+                    lookup(Utf8::first_low_nibble,_mm256_and_si256(previous_1,nibble_mask))
+                ),
+                lookup(Utf8::second_high_nibble,_mm256_and_si256(_mm256_srli_epi16(block,4),nibble_mask))
+            );
+
+            //0x80 where a third or fourth byte is due, two_continuations marks where one was seen, they have to agree
+            auto is_third_byte = _mm256_subs_epu8(previous_bytes<2>(block,previous),_mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            auto is_fourth_byte = _mm256_subs_epu8(previous_bytes<3>(block,previous),_mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            auto must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte,is_fourth_byte),_mm256_set1_epi8(static_cast<char>(0x80)));
+
+            return _mm256_xor_si256(must_be_continuation,special_cases);
+        };
+
+        //a whole block of ASCII only has to close what the block before left open. Only whether a block has an error is known,
+        //the exact position is found by the scalar validator, restarting at the first character that reaches into the block
+        __attribute__((target("avx2")))
+        inline const unsigned char* validate_utf8(const unsigned char* begin, const unsigned char* end)
+        {
+            auto previous = _mm256_setzero_si256();
+            auto previous_incomplete = _mm256_setzero_si256();
+            auto incomplete_limits = _mm256_load_si256(reinterpret_cast<const __m256i*>(Utf8::incomplete_limits));
+            auto position = begin;
+
+            auto find_error = [begin, end](const unsigned char* block_begin) {
+                auto restart = block_begin - (block_begin - begin < 3 ? block_begin - begin : 3);
+                while (restart < block_begin && (*restart & 0xC0) == 0x80)
+                {
+                    restart++;
+                };
+                return Scalar::validate_utf8(restart,end);
+            };
+
+            while (position < end)
+            {
+                __m256i block;
+                if (end - position >= 32)
+                {
+                    block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(position));
+                } else {
+                    //the tail is padded with zeros, which are ASCII and leave no sequence open
+                    alignas(32) unsigned char tail[32] = {};
+                    memcpy(tail,position,end - position);
+                    block = _mm256_load_si256(reinterpret_cast<const __m256i*>(tail));
+                };
+
+                __m256i errors;
+                if (_mm256_movemask_epi8(block) != 0)
+                {
+                    errors = utf8_block_errors(block,previous);
+                    previous_incomplete = _mm256_subs_epu8(block,incomplete_limits);
+                } else {
+                    errors = previous_incomplete;
+                    previous_incomplete = _mm256_setzero_si256();
+                };
+
+                if (!_mm256_testz_si256(errors,errors))
+                {
+                    return find_error(position);
+                };
+
+                previous = block;
+                position += 32;
+            };
+
+            if (!_mm256_testz_si256(previous_incomplete,previous_incomplete))
+            {
+                return find_error(end);
+            };
+
+            return end;
+        };
+
+
+        __attribute__((target("avx2")))
+        inline const unsigned char* find_either(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, unsigned char first, unsigned char second)
+        {
+            auto first_block = _mm256_set1_epi8(static_cast<char>(first));
+            auto second_block = _mm256_set1_epi8(static_cast<char>(second));
+            while (begin < end && readable_end - begin >= 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+                uint32_t found_mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block,first_block),_mm256_cmpeq_epi8(block,second_block)));
+                if (found_mask)
+                {
+                    return clamp(begin + first_set_bit(found_mask),end);
+                };
+                begin += 32;
+            };
+            return SSE2::find_either(begin,end,readable_end,first,second);
+        };
+
+        //two nibble lookups and an and per 32 bytes, see LuaUByteSet
+        __attribute__((target("avx2")))
+        inline const unsigned char* skip_luau_code(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+        {
+            auto low_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LuaUByteSet::low_nibble)));
+            auto high_table = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(LuaUByteSet::high_nibble)));
+            auto nibble_mask = _mm256_set1_epi8(0x0F);
+
+            while (begin < end && readable_end - begin >= 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+                auto low_bits = _mm256_shuffle_epi8(low_table,_mm256_and_si256(block,nibble_mask));
+                auto high_bits = _mm256_shuffle_epi8(high_table,_mm256_and_si256(_mm256_srli_epi16(block,4),nibble_mask));
+                auto not_in_set = _mm256_cmpeq_epi8(_mm256_and_si256(low_bits,high_bits),_mm256_setzero_si256());
+
+                uint32_t stop_mask = ~_mm256_movemask_epi8(not_in_set);
+                if (stop_mask)
+                {
+                    return clamp(begin + first_set_bit(stop_mask),end);
+                };
+                begin += 32;
+            };
+            return SSE2::skip_luau_code(begin,end,readable_end);
+        };
+
+        __attribute__((target("avx2")))
+        inline const unsigned char* find_long_bracket_close(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, size_t level)
+        {
+            auto bracket_block = _mm256_set1_epi8(']');
+            while (begin < end && readable_end - begin >= 32)
+            {
+                auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+                uint32_t found_mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block,bracket_block),_mm256_cmpeq_epi8(block,_mm256_setzero_si256())));
+                while (found_mask)
+                {
+                    auto position = begin + first_set_bit(found_mask);
+                    if (position >= end || *position == '\0' || Scalar::is_long_bracket_close(position,end,level))
+                    {
+                        return clamp(position,end);
+                    };
+                    found_mask &= found_mask - 1;
+                };
+                begin += 32;
+            };
+            return SSE2::find_long_bracket_close(begin,end,readable_end,level);
+        };
+    };
+#endif
+
+    struct Kernels {
+        const unsigned char* (*find_either)(const unsigned char*, const unsigned char*, const unsigned char*, unsigned char, unsigned char);
+        const unsigned char* (*skip_luau_code)(const unsigned char*, const unsigned char*, const unsigned char*);
+        const unsigned char* (*find_long_bracket_close)(const unsigned char*, const unsigned char*, const unsigned char*, size_t);
+        const unsigned char* (*validate_utf8)(const unsigned char*, const unsigned char*);
+        size_t (*count_byte)(const unsigned char*, const unsigned char*, unsigned char);
+    };
+
+    inline Kernels select_kernels()
+    {
+#if CLUA_SCANNER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return Kernels { AVX2::find_either, AVX2::skip_luau_code, AVX2::find_long_bracket_close, AVX2::validate_utf8, AVX2::count_byte };
+        };
+        return Kernels { SSE2::find_either, SSE2::skip_luau_code, SSE2::find_long_bracket_close, SSE2::validate_utf8, SSE2::count_byte };
+#else
+        return Kernels {
+            [](const unsigned char* begin, const unsigned char* end, const unsigned char*, unsigned char first, unsigned char second) {
+                return Scalar::find_either(begin,end,first,second);
+            },
+            [](const unsigned char* begin, const unsigned char* end, const unsigned char*) {
+                return Scalar::skip_luau_code(begin,end);
+            },
+            [](const unsigned char* begin, const unsigned char* end, const unsigned char*, size_t level) {
+                return Scalar::find_long_bracket_close(begin,end,level);
+            },
+            Scalar::validate_utf8,
+            Scalar::count_byte
+        };
+#endif
+    };
+
+    inline const Kernels kernels = select_kernels();
+
+    //Identifier and whitespace runs are short, a 16 byte block usually covers them whole, so they go straight to SSE2
+    //(part of the x86-64 baseline) instead of paying an indirect call. Comment bodies are long and use the dispatched kernels.
+    inline const unsigned char* skip_identifier(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+    {
+#if CLUA_SCANNER_X86
+        return SSE2::skip_identifier(begin,end,readable_end);
+#else
+        return Scalar::skip_identifier(begin,end);
+#endif
+    };
+
+    inline const unsigned char* skip_whitespace(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+    {
+#if CLUA_SCANNER_X86
+        return SSE2::skip_whitespace(begin,end,readable_end);
+#else
+        return Scalar::skip_whitespace(begin,end);
+#endif
+    };
+
+    inline const unsigned char* find_either(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, unsigned char first, unsigned char second)
+    {
+        return kernels.find_either(begin,end,readable_end,first,second);
+    };
+
+    //skips LuaU code up to the next byte in Scalar::is_luau_stop_byte
+    inline const unsigned char* skip_luau_code(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end)
+    {
+        return kernels.skip_luau_code(begin,end,readable_end);
+    };
+
+    //first ']' '='*level ']' closer of a Lua long bracket in [begin, end), stops early on '\0'
+    inline const unsigned char* find_long_bracket_close(const unsigned char* begin, const unsigned char* end, const unsigned char* readable_end, size_t level)
+    {
+        return kernels.find_long_bracket_close(begin,end,readable_end,level);
+    };
+
+    //first byte in [begin, end) where the text stops being well formed UTF-8, or end. Bytes past end are never read,
+    //a sequence cut off by end is an error
+    inline const unsigned char* validate_utf8(const unsigned char* begin, const unsigned char* end)
+    {
+        return kernels.validate_utf8(begin,end);
+    };
+
+    //how often byte occurs in [begin, end), sizes the line index before it is filled
+    inline size_t count_byte(const unsigned char* begin, const unsigned char* end, unsigned char byte)
+    {
+        return kernels.count_byte(begin,end,byte);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <lexer/streaming_lexer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Util {
+
+   StreamingLexer::StreamingLexer(ReadChunk read_chunk, void* context) : StreamingLexer(read_chunk,context,Options())
+   {};
+
+   StreamingLexer::StreamingLexer(ReadChunk read_chunk, void* context, const Options& options) :
+      read_chunk(read_chunk),
+      context(context),
+      chunk_size(std::max<size_t>(options.chunk_size,1)),
+      window_size(std::max(options.window_size,chunk_size))
+   {
+      buffer.reset(new unsigned char[window_size + PaddedSource::padding]);
+      std::memset(buffer.get(),0,PaddedSource::padding);
+      lexer.set_interner(options.interner);
+   };
+
+   void StreamingLexer::grow_window()
+   {
+      auto grown_buffer = new unsigned char[window_size * 2 + PaddedSource::padding];
+      std::memcpy(grown_buffer,buffer.get(),filled);
+      buffer.reset(grown_buffer);
+      window_size *= 2;
+   };
+
+   void StreamingLexer::refill()
+   {
+      while (!input_ended && filled < window_size)
+      {
+         auto read_count = read_chunk(context,buffer.get() + filled,std::min(chunk_size,window_size - filled));
+         if (read_count <= 0)
+         {
+            read_failed = read_count < 0;
+            input_ended = true;
+            break;
+         };
+         filled += static_cast<size_t>(read_count);
+
+         //offsets are 32 bit, so the input is cut where they end and the stream ends there like after a failed read
+         if (base + filled > max_source_size) [[unlikely]]
+         {
+            filled = max_source_size - base;
+            too_large = true;
+            read_failed = true;
+            input_ended = true;
+            break;
+         };
+      };
+
+      std::memset(buffer.get() + filled,0,PaddedSource::padding);
+   };
+
+   //drops everything before the checkpoint, the lexer is resumed on a fresh context so the side table sizes start over too
+   void StreamingLexer::compact()
+   {
+      auto kept_from = checkpoint.index;
+
+      std::memmove(buffer.get(),buffer.get() + kept_from,filled - kept_from);
+      filled -= kept_from;
+      base += kept_from;
+
+      checkpoint.index = 0;
+      checkpoint.error_count = 0;
+      checkpoint.number_count = 0;
+      checkpoint.symbol_count = 0;
+      checkpoint.keyword_count = 0;
+
+      if (filled == window_size)
+      {
+         grow_window();
+      };
+   };
+
+   bool StreamingLexer::tokenize_next(TokenStream& token_stream)
+   {
+      if (finished)
+      {
+         return false;
+      };
+
+      auto first_token = token_stream.size();
+
+      while (token_stream.size() == first_token && !finished)
+      {
+         compact();
+         refill();
+
+         Source window(buffer.get(),filled,true);
+         lexer.resume(window,checkpoint);
+
+         while (true)
+         {
+            checkpoint = lexer.save();
+            auto token = lexer.process_next_token();
+
+            //before the real end a token touching the end of the window may continue in the next chunk,
+            //an EndOfFile inside the filled bytes is a '\0' in the input and ends it for good
+            bool may_be_cut = !input_ended && (token.token_type == TokenType::EndOfFile ?
+               token.offset >= filled :
+               token.offset + token.length + lookahead > filled);
+            if (may_be_cut)
+            {
+               break;
+            };
+
+            token.offset += base;
+            token_stream.push_back_from(token,lexer.get_context());
+
+            //past filled the EndOfFile token has been consumed already, whatever mode the lexer was left in
+            if (token.token_type == TokenType::EndOfFile || lexer.get_context().source.index > filled)
+            {
+               finished = true;
+               break;
+            };
+         };
+      };
+
+      return true;
+   };
+
+   size_t StreamingLexer::tokenize_all(TokenStream& token_stream)
+   {
+      auto first_token = token_stream.size();
+      while (tokenize_next(token_stream));
+      return token_stream.size() - first_token;
+   };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+
+#include <stdint.h>
+#include <memory>
+
+namespace Util {
+
+    //Lexes input that arrives in pieces (stdin, pipes, huge bundles) through a bounded window.
+    //The window is refilled chunk by chunk, a token is only handed out once it ends more than lookahead bytes before
+    //the end of what has been read so far. The rest of the window is moved to the front on refill and lexing resumes
+    //from the checkpoint before the first token that wasn't handed out, so tokens crossing a refill are lexed again whole.
+    //Offsets are global. The window only grows when a single token (an unclosed comment, a huge Lua block) doesn't fit.
+    class StreamingLexer {
+        public:
+        //returns the number of bytes written to destination, 0 at the end of the input and a negative value on failure
+        using ReadChunk = long long (*)(void* context, unsigned char* destination, size_t capacity);
+
+        //bytes past a token's end the lexer may have looked at to end it
+        static constexpr size_t lookahead = 8;
+
+        struct Options {
+            size_t chunk_size = 1024 * 1024;
+            size_t window_size = 4 * 1024 * 1024;
+            Interner* interner = nullptr; //identifier tokens get their atoms from it, it has to outlive the streaming lexer
+        };
+
+        private:
+        ReadChunk read_chunk;
+        void* context;
+        size_t chunk_size;
+
+        std::unique_ptr<unsigned char[]> buffer;
+        size_t window_size;
+        size_t filled = 0;
+        size_t base = 0; //global offset of buffer[0]
+
+        bool input_ended = false;
+        bool read_failed = false;
+        bool too_large = false;
+        bool finished = false;
+
+        Lexer lexer;
+        LexerCheckpoint checkpoint;
+
+        void grow_window();
+        void refill();
+        void compact();
+
+        public:
+        StreamingLexer(ReadChunk read_chunk, void* context);
+        StreamingLexer(ReadChunk read_chunk, void* context, const Options& options);
+
+        StreamingLexer(const StreamingLexer&) = delete;
+        StreamingLexer& operator=(const StreamingLexer&) = delete;
+
+        //appends the next run of complete tokens, the last call appends the EndOfFile token.
+        //Returns false once everything has been handed out, clear token_stream between calls to keep memory bounded
+        bool tokenize_next(TokenStream& token_stream);
+
+        //lexes the whole input into token_stream, returns how many tokens were appended
+        size_t tokenize_all(TokenStream& token_stream);
+
+        //true when read_chunk failed, the stream then ends as if the input had ended there
+        inline bool has_failed() const noexcept
+        {
+            return read_failed;
+        };
+
+        //true when the input went past max_source_size, has_failed() is true then as well
+        inline bool is_too_large() const noexcept
+        {
+            return too_large;
+        };
+
+        inline size_t see_window_size() const noexcept
+        {
+            return window_size;
+        };
+
+        inline size_t bytes_read() const noexcept
+        {
+            return base + filled;
+        };
+    };
+}
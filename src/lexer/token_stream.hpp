@@ -0,0 +1,258 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+
+#include <stdint.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+namespace Util {
+
+    using namespace std::string_literals;
+
+    //Structure of arrays token storage, 12 bytes per token (type 1, flags 1, offset 4, length 2, payload 4) instead of the 24 of a TokenGeneric.
+    //Payload indices point into the side tables owned by the stream itself, so a stream outlives the lexer that filled it.
+    class TokenStream {
+        public:
+        //lengths that don't fit in 16 bits store this and keep the real length in long_lengths
+        static constexpr uint16_t long_length = UINT16_MAX;
+
+        private:
+        std::vector<TokenType> types;
+        std::vector<uint8_t> token_flags;
+        std::vector<uint32_t> offsets;
+        std::vector<uint16_t> lengths;
+        std::vector<uint32_t> payloads;
+        std::vector<std::pair<uint32_t,uint32_t>> long_lengths; //(token index, length), sorted since tokens are only appended
+
+        public:
+        std::vector<Error> errors;
+        std::vector<NumberHint> numbers;
+        std::vector<SymbolClassifier::SymbolKind> symbols;
+        std::vector<KeywordClassifier::Keyword> keywords;
+        std::vector<Atom> atoms; //same index as keywords
+
+        TokenStream() = default;
+
+        inline size_t size() const noexcept
+        {
+            return types.size();
+        };
+
+        inline bool empty() const noexcept
+        {
+            return types.empty();
+        };
+
+        inline void reserve(size_t token_count)
+        {
+            types.reserve(token_count);
+            token_flags.reserve(token_count);
+            offsets.reserve(token_count);
+            lengths.reserve(token_count);
+            payloads.reserve(token_count);
+        };
+
+        inline void clear()
+        {
+            types.clear();
+            token_flags.clear();
+            offsets.clear();
+            lengths.clear();
+            payloads.clear();
+            long_lengths.clear();
+            errors.clear();
+            numbers.clear();
+            symbols.clear();
+            keywords.clear();
+            atoms.clear();
+        };
+
+        //the token's payload_index has to point into this stream's side tables already
+        inline void push_back(const TokenGeneric& token)
+        {
+            //the lexer refuses sources past max_source_size up front, so this only catches tokens made up elsewhere
+            Assert(
+                token.offset <= max_source_size && token.length <= max_source_size,
+                LexerError +
+                "token stream offsets are 32 bit, source is too large"s +
+                LexerErrorEnd
+            );
+
+            auto token_index = static_cast<uint32_t>(types.size());
+
+            types.push_back(token.token_type);
+            token_flags.push_back(token.flags);
+            offsets.push_back(static_cast<uint32_t>(token.offset));
+            payloads.push_back(token.payload_index);
+
+            if (token.length < long_length) [[likely]]
+            {
+                lengths.push_back(static_cast<uint16_t>(token.length));
+            } else {
+                lengths.push_back(long_length);
+                long_lengths.emplace_back(token_index,static_cast<uint32_t>(token.length));
+            };
+        };
+
+        //copies the token together with its payload entry out of side_tables (a LexerContext or another TokenStream)
+        template <typename SideTables>
+        inline void push_back_from(TokenGeneric token, const SideTables& side_tables)
+        {
+            if (token.payload_index != no_payload)
+            {
+                token.payload_index = copy_payload(token.token_type,token.payload_index,side_tables);
+
+                //the token may have been moved (streamed, relexed), the error follows it
+                if (token.token_type == TokenType::Error)
+                {
+                    errors[token.payload_index].offset = token.offset;
+                    errors[token.payload_index].length = token.length;
+                };
+            };
+            push_back(token);
+        };
+
+        //appends all of other's tokens, their payload entries are copied into this stream's side tables
+        inline void append(const TokenStream& other)
+        {
+            reserve(size() + other.size());
+            for (size_t token_index = 0; token_index < other.size(); token_index++)
+            {
+                push_back_from(other[token_index],other);
+            };
+        };
+
+        inline TokenType type(size_t token_index) const
+        {
+            return types[token_index];
+        };
+
+        inline uint8_t flags(size_t token_index) const
+        {
+            return token_flags[token_index];
+        };
+
+        inline size_t offset(size_t token_index) const
+        {
+            return offsets[token_index];
+        };
+
+        inline size_t length(size_t token_index) const
+        {
+            auto length = lengths[token_index];
+            if (length != long_length) [[likely]]
+            {
+                return length;
+            };
+
+            auto long_length_it = std::lower_bound(
+                long_lengths.begin(),
+                long_lengths.end(),
+                static_cast<uint32_t>(token_index),
+                [](const auto& entry, uint32_t index) { return entry.first < index; }
+            );
+
+            Assert(
+                long_length_it != long_lengths.end() && long_length_it->first == token_index,
+                LexerError +
+                "long length escape without a long_lengths entry"s +
+                LexerErrorEnd
+            );
+
+            return long_length_it->second;
+        };
+
+        inline uint32_t payload(size_t token_index) const
+        {
+            return payloads[token_index];
+        };
+
+        inline const std::vector<TokenType>& get_types() const noexcept
+        {
+            return types;
+        };
+
+        inline TokenGeneric operator[](size_t token_index) const
+        {
+            TokenGeneric token;
+            token.token_type = type(token_index);
+            token.flags = flags(token_index);
+            token.payload_index = payload(token_index);
+            token.offset = offset(token_index);
+            token.length = length(token_index);
+            return token;
+        };
+
+        inline SymbolClassifier::SymbolKind symbol(size_t token_index) const
+        {
+            assert_payload(token_index,TokenType::Symbol);
+            return symbols[payloads[token_index]];
+        };
+
+        inline KeywordClassifier::Keyword keyword(size_t token_index) const
+        {
+            assert_payload(token_index,TokenType::Identifier);
+            return keywords[payloads[token_index]];
+        };
+
+        //no_atom when the lexer had no interner
+        inline Atom atom(size_t token_index) const
+        {
+            assert_payload(token_index,TokenType::Identifier);
+            return atoms[payloads[token_index]];
+        };
+
+        inline const NumberHint& number(size_t token_index) const
+        {
+            assert_payload(token_index,TokenType::Numeric);
+            return numbers[payloads[token_index]];
+        };
+
+        inline const Error& error(size_t token_index) const
+        {
+            assert_payload(token_index,TokenType::Error);
+            return errors[payloads[token_index]];
+        };
+
+        private:
+        inline void assert_payload([[maybe_unused]] size_t token_index, [[maybe_unused]] TokenType expected) const
+        {
+            Assert(
+                types[token_index] == expected && payloads[token_index] != no_payload,
+                LexerError +
+                "token has no payload of the requested type"s +
+                LexerErrorEnd
+            );
+        };
+
+        template <typename SideTables>
+        inline uint32_t copy_payload(TokenType token_type, uint32_t payload_index, const SideTables& side_tables)
+        {
+            switch (token_type)
+            {
+            case TokenType::Error:
+                errors.push_back(side_tables.errors[payload_index]);
+                return static_cast<uint32_t>(errors.size() - 1);
+            case TokenType::Numeric:
+                numbers.push_back(side_tables.numbers[payload_index]);
+                return static_cast<uint32_t>(numbers.size() - 1);
+            case TokenType::Symbol:
+                symbols.push_back(side_tables.symbols[payload_index]);
+                return static_cast<uint32_t>(symbols.size() - 1);
+            case TokenType::Identifier:
+                keywords.push_back(side_tables.keywords[payload_index]);
+                atoms.push_back(side_tables.atoms[payload_index]);
+                return static_cast<uint32_t>(keywords.size() - 1);
+            default:
+                Assert(false,
+                    LexerError +
+                    "token type carries no payload"s +
+                    LexerErrorEnd
+                );
+                return no_payload;
+            };
+        };
+    };
+}
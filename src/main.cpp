@@ -1,25 +1,55 @@
 #include <lexer/lexer.hpp>
+#include <driver/lex_driver.hpp>
+#include <driver/check_driver.hpp>
 #include <iostream>
 #include <string>
+#include <ranges>
 
-int main()
+int main(int argc, char** argv)
 {
-    std::cout << "Write some expression: " << std::endl;
-    
-    std::string input;
-    
-    if (!std::getline(std::cin, input) || input.empty()) {
-        std::cerr << "No input provided." << std::endl;
-        return 1;
+    if (argc > 1 && std::string_view(argv[1]) == "clua-lex")
+    {
+        return Driver::run_clua_lex(argc - 2, argv + 2);
+    }
+
+    if (argc > 1 && std::string_view(argv[1]) == "clua-check")
+    {
+        return Driver::run_clua_check(argc - 2, argv + 2);
+    }
+
+    Util::PaddedSource padded_input;
+
+    if (argc > 1)
+    {
+        auto file_input = Util::PaddedSource::from_file(argv[1]);
+
+        if (!file_input) {
+            std::cerr << Driver::describe_unreadable(argv[1], Driver::is_too_large(argv[1])) << std::endl;
+            return 1;
+        }
+
+        padded_input = std::move(*file_input);
+    } else {
+        std::cout << "Write some expression: " << std::endl;
+        
+        std::string input;
+        
+        if (!std::getline(std::cin, input) || input.empty()) {
+            std::cerr << "No input provided." << std::endl;
+            return 1;
+        }
+
+        padded_input = Util::PaddedSource(input);
     }
 
-    Util::Source source(reinterpret_cast<unsigned char*>(input.data()),input.length());
+    Util::Source source = padded_input.view();
+    auto source_text = reinterpret_cast<const char*>(padded_input.data());
 
     Util::Lexer lexer(source);
 
-    auto current_token = lexer.process_next_token();
+    auto is_not_end = [](const Util::TokenGeneric& token) { return token.token_type != Util::TokenType::EndOfFile; };
 
-    while (current_token.token_type != Util::TokenType::EndOfFile)
+    for (const auto& current_token : lexer.tokens() | std::views::take_while(is_not_end))
     {
         if (current_token.token_type == Util::TokenType::Error)
         {
@@ -27,9 +57,8 @@ int main()
             std::cout << "error code: " << (unsigned)lexer.get_last_error().error_code << std::endl;
         };
 
-        std::cout << "Token Type: " << (unsigned)current_token.token_type << " " << std::string_view(input.data() + current_token.offset,current_token.length) << std::endl;
-        current_token = lexer.process_next_token();
+        std::cout << "Token Type: " << (unsigned)current_token.token_type << " " << std::string_view(source_text + current_token.offset,current_token.length) << std::endl;
     }
 
     return 0;
-}
\ No newline at end of file
+}
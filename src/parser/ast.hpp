@@ -0,0 +1,281 @@
+#pragma once
+
+#include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+#include <arena.hpp>
+
+#include <stdint.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define NODE_KINDS \
+    NodeKind(Module) \
+    NodeKind(Block) \
+    NodeKind(VariableDeclaration) \
+    NodeKind(FunctionDeclaration) \
+    NodeKind(ParameterList) \
+    NodeKind(Parameter) \
+    NodeKind(Type) \
+    NodeKind(If) \
+    NodeKind(For) \
+    NodeKind(While) \
+    NodeKind(Return) \
+    NodeKind(Break) \
+    NodeKind(Continue) \
+    NodeKind(ExpressionStatement) \
+    NodeKind(Empty) \
+    NodeKind(LuaStatement) \
+    NodeKind(CaptureList) \
+    NodeKind(Capture) \
+    NodeKind(LuaCode) \
+    NodeKind(Export) \
+    NodeKind(NameList) \
+    NodeKind(Identifier) \
+    NodeKind(NumberLiteral) \
+    NodeKind(StringLiteral) \
+    NodeKind(CharLiteral) \
+    NodeKind(BooleanLiteral) \
+    NodeKind(NullLiteral) \
+    NodeKind(Unary) \
+    NodeKind(Postfix) \
+    NodeKind(Binary) \
+    NodeKind(Assignment) \
+    NodeKind(Conditional) \
+    NodeKind(Call) \
+    NodeKind(Member) \
+    NodeKind(Index) \
+    NodeKind(Cast) \
+    NodeKind(Error)
+
+namespace ASTParser {
+
+    using namespace std::string_literals;
+
+    constexpr auto ParserError = "Parser Error: "s;
+    constexpr auto ParserErrorEnd = "\n"s;
+
+    enum class NodeKind: uint8_t {
+        #define NodeKind(NodeKindValue) \
+            NodeKindValue,
+            NODE_KINDS
+        #undef NodeKind
+    };
+
+    inline const char* node_kind_to_string(NodeKind node_kind)
+    {
+        switch (node_kind)
+        {
+        #define NodeKind(NodeKindValue) \
+            case NodeKind::NodeKindValue: return #NodeKindValue;
+                NODE_KINDS
+        #undef NodeKind
+                default: return "<Unknown>";
+        };
+    };
+
+    //meaning depends on the node: qualifiers on declarations, & and * on types, & and copy on captures
+    namespace NodeFlags {
+        constexpr uint16_t Buffer = 1 << 0;
+        constexpr uint16_t Extern = 1 << 1;
+        constexpr uint16_t Virtual = 1 << 2;
+        constexpr uint16_t Const = 1 << 3;
+        constexpr uint16_t Static = 1 << 4;
+        constexpr uint16_t Inline = 1 << 5;
+        constexpr uint16_t Reference = 1 << 6;
+        constexpr uint16_t Pointer = 1 << 7;
+        constexpr uint16_t Copy = 1 << 8;
+    };
+
+    using NodeIndex = uint32_t;
+    inline constexpr NodeIndex no_node = UINT32_MAX;
+
+    //first and last token of a node, both inclusive, as indices into Ast::tokens
+    struct TokenSpan {
+        uint32_t first;
+        uint32_t last;
+    };
+
+    //Structure of arrays node storage, 20 bytes per node plus 4 per child, all of it taken from one arena.
+    //A node is appended once it is finished, so its children always come before it (post order) and the root is the last node.
+    //The children of a node are one contiguous run of child_indices that starts where the previous node's run ended.
+    //There are no pointers anywhere, the arrays can be written out and read back as they are
+    class NodePool {
+        private:
+        Util::ArenaVector<NodeKind> kinds;
+        Util::ArenaVector<SymbolClassifier::SymbolKind> symbols; //operator of Unary, Postfix, Binary, Assignment and Member
+        Util::ArenaVector<uint16_t> node_flags;
+        Util::ArenaVector<uint32_t> tokens; //the node's main token: its name, operator or literal
+        Util::ArenaVector<uint32_t> first_tokens;
+        Util::ArenaVector<uint32_t> last_tokens;
+        Util::ArenaVector<uint32_t> children_ends;
+        Util::ArenaVector<NodeIndex> child_indices;
+
+        public:
+        explicit NodePool(Util::Arena* arena) :
+            kinds(arena),
+            symbols(arena),
+            node_flags(arena),
+            tokens(arena),
+            first_tokens(arena),
+            last_tokens(arena),
+            children_ends(arena),
+            child_indices(arena)
+        {};
+
+        inline size_t size() const noexcept
+        {
+            return kinds.size();
+        };
+
+        inline void reserve(size_t node_count)
+        {
+            kinds.reserve(node_count);
+            symbols.reserve(node_count);
+            node_flags.reserve(node_count);
+            tokens.reserve(node_count);
+            first_tokens.reserve(node_count);
+            last_tokens.reserve(node_count);
+            children_ends.reserve(node_count);
+            child_indices.reserve(node_count);
+        };
+
+        //children have to be in the pool already
+        inline NodeIndex push_back(NodeKind kind, SymbolClassifier::SymbolKind symbol, uint16_t flags, uint32_t token, TokenSpan span, std::span<const NodeIndex> children)
+        {
+            Assert(
+                kinds.size() < no_node && child_indices.size() + children.size() <= UINT32_MAX,
+                ParserError +
+                "node indices are 32 bit, too many nodes"s +
+                ParserErrorEnd
+            );
+
+            auto node_index = static_cast<NodeIndex>(kinds.size());
+
+            kinds.push_back(kind);
+            symbols.push_back(symbol);
+            node_flags.push_back(flags);
+            tokens.push_back(token);
+            first_tokens.push_back(span.first);
+            last_tokens.push_back(span.last);
+            child_indices.insert(child_indices.end(),children.begin(),children.end());
+            children_ends.push_back(static_cast<uint32_t>(child_indices.size()));
+
+            return node_index;
+        };
+
+        //drops the nodes from node_count on, nothing kept may have them as children
+        inline void truncate(size_t node_count)
+        {
+            if (node_count >= kinds.size())
+            {
+                return;
+            };
+
+            kinds.resize(node_count);
+            symbols.resize(node_count);
+            node_flags.resize(node_count);
+            tokens.resize(node_count);
+            first_tokens.resize(node_count);
+            last_tokens.resize(node_count);
+            children_ends.resize(node_count);
+            child_indices.resize(node_count > 0 ? children_ends.back() : 0);
+        };
+
+        inline NodeKind kind(NodeIndex node_index) const
+        {
+            return kinds[node_index];
+        };
+
+        inline SymbolClassifier::SymbolKind symbol(NodeIndex node_index) const
+        {
+            return symbols[node_index];
+        };
+
+        inline uint16_t flags(NodeIndex node_index) const
+        {
+            return node_flags[node_index];
+        };
+
+        inline uint32_t token(NodeIndex node_index) const
+        {
+            return tokens[node_index];
+        };
+
+        inline TokenSpan span(NodeIndex node_index) const
+        {
+            return TokenSpan{first_tokens[node_index],last_tokens[node_index]};
+        };
+
+        inline std::span<const NodeIndex> children(NodeIndex node_index) const
+        {
+            auto children_begin = node_index == 0 ? 0 : children_ends[node_index - 1];
+            return std::span<const NodeIndex>(child_indices.data() + children_begin,children_ends[node_index] - children_begin);
+        };
+
+        inline size_t memory_bytes() const noexcept
+        {
+            return size() * (sizeof(NodeKind) + sizeof(SymbolClassifier::SymbolKind) + sizeof(uint16_t) + 4 * sizeof(uint32_t)) +
+                child_indices.size() * sizeof(NodeIndex);
+        };
+    };
+
+    enum class ParseErrorCode: uint8_t {
+        UnexpectedToken,
+        ExpectedExpression,
+        ExpectedIdentifier,
+        ExpectedSymbol,
+        ExpectedTerminator,
+        ExpectedLua,
+        LexerError,
+    };
+
+    struct ParseError {
+        ParseErrorCode error_code;
+        uint32_t token; //where it went wrong, in Ast::tokens
+        SymbolClassifier::SymbolKind expected_symbol = SymbolClassifier::SymbolKind::UNKNOWN;
+    };
+
+    //Nodes live in the arena the parser was given, tokens are the significant tokens the parser pulled from the lexer
+    struct Ast {
+        NodePool nodes;
+        Util::TokenStream tokens;
+        std::vector<ParseError> errors;
+        const unsigned char* source_text = nullptr;
+        NodeIndex root = no_node;
+
+        explicit Ast(Util::Arena* arena) : nodes(arena)
+        {};
+
+        inline std::string_view token_text(uint32_t token_index) const
+        {
+            return std::string_view(reinterpret_cast<const char*>(source_text) + tokens.offset(token_index),tokens.length(token_index));
+        };
+
+        inline std::string_view text(NodeIndex node_index) const
+        {
+            return token_text(nodes.token(node_index));
+        };
+
+        //of a node whose main token is an identifier (Identifier, Capture, Parameter, declarations), resolving names compares these
+        inline Util::Atom atom(NodeIndex node_index) const
+        {
+            return tokens.atom(nodes.token(node_index));
+        };
+
+        //all the source text the node was parsed from
+        inline std::string_view span_text(NodeIndex node_index) const
+        {
+            auto span = nodes.span(node_index);
+            auto begin = tokens.offset(span.first);
+            auto end = std::max(begin,tokens.offset(span.last) + tokens.length(span.last));
+            return std::string_view(reinterpret_cast<const char*>(source_text) + begin,end - begin);
+        };
+    };
+
+    //(Kind text children...) for debugging and tests
+    std::string dump(const Ast& ast, NodeIndex node_index);
+};
+
+#undef NODE_KINDS
@@ -1,5 +1,972 @@
 #include "parser.hpp"
 
-namespace ASTParser{
-    
-};
\ No newline at end of file
+namespace ASTParser {
+
+   using Util::TokenType;
+   using SymbolClassifier::SymbolKind;
+   using KeywordClassifier::Keyword;
+
+   //binding powers, left associative operators parse their right side with the same power, right associative ones with one less.
+   //The else branch of ?: takes assignments like in C, a ? b : c = d is a ? b : (c = d)
+   constexpr uint8_t assignment_power = 2;
+   constexpr uint8_t conditional_power = 4;
+   constexpr uint8_t prefix_power = 26;
+   constexpr uint8_t postfix_power = 28;
+
+   constexpr uint8_t infix_binding_power(SymbolKind symbol)
+   {
+      switch (symbol)
+      {
+      case SymbolKind::EQUAL:
+      case SymbolKind::PLUS_EQUAL:
+      case SymbolKind::MINUS_EQUAL:
+      case SymbolKind::STAR_EQUAL:
+      case SymbolKind::SLASH_EQUAL:
+      case SymbolKind::PERCENT_EQUAL:
+      case SymbolKind::BIT_AND_EQUAL:
+      case SymbolKind::BIT_OR_EQUAL:
+      case SymbolKind::BIT_XOR_EQUAL:
+      case SymbolKind::BIT_LSHIFT_EQUAL:
+      case SymbolKind::BIT_RSHIFT_EQUAL:
+      case SymbolKind::TERNARY_ASSIGN:
+         return assignment_power;
+      case SymbolKind::QUESTION:
+         return conditional_power;
+      case SymbolKind::LOGICAL_OR:
+         return 6;
+      case SymbolKind::LOGICAL_AND:
+         return 8;
+      case SymbolKind::BIT_OR:
+         return 10;
+      case SymbolKind::BIT_XOR:
+         return 12;
+      case SymbolKind::BIT_AND:
+         return 14;
+      case SymbolKind::EQUAL_EQUAL:
+      case SymbolKind::NOT_EQUAL:
+         return 16;
+      case SymbolKind::LESS:
+      case SymbolKind::LESS_EQUAL:
+      case SymbolKind::GREATER:
+      case SymbolKind::GREATER_EQUAL:
+         return 18;
+      case SymbolKind::BIT_LSHIFT:
+      case SymbolKind::BIT_RSHIFT:
+         return 20;
+      case SymbolKind::PLUS:
+      case SymbolKind::MINUS:
+         return 22;
+      case SymbolKind::STAR:
+      case SymbolKind::SLASH:
+      case SymbolKind::PERCENT:
+         return 24;
+      case SymbolKind::LPAREN:
+      case SymbolKind::LBRACKET:
+      case SymbolKind::DOT:
+      case SymbolKind::ARROW:
+      case SymbolKind::DOUBLE_PLUS:
+      case SymbolKind::DOUBLE_MINUS:
+         return postfix_power;
+      default:
+         return 0;
+      };
+   };
+
+   constexpr bool is_prefix_operator(SymbolKind symbol)
+   {
+      switch (symbol)
+      {
+      case SymbolKind::PLUS:
+      case SymbolKind::MINUS:
+      case SymbolKind::BANG:
+      case SymbolKind::BIT_NOT:
+      case SymbolKind::DOUBLE_PLUS:
+      case SymbolKind::DOUBLE_MINUS:
+      case SymbolKind::STAR:
+      case SymbolKind::BIT_AND:
+         return true;
+      default:
+         return false;
+      };
+   };
+
+   Parser::Parser(Util::Source& source, Util::Arena& arena, Util::Interner& interner) : source(source), lexer(this->source,arena), ast(&arena)
+   {
+      ast.source_text = this->source.get_source_buffer();
+      lexer.set_interner(&interner);
+
+      words.buffer = interner.intern("buffer");
+      words.copy = interner.intern("copy");
+      words.export_names = interner.intern("export");
+      words.as = interner.intern("as");
+      words.lua = interner.intern("LUA");
+   };
+
+   //index of the token distance tokens ahead, lexing up to it on demand. Past the end it is the EndOfFile token
+   size_t Parser::token_at(size_t distance)
+   {
+      //the lexer turns a source whose offsets don't fit the token stream into a single error before the EndOfFile token
+      if (ast.tokens.empty() && lexer.get_context().source.size() > Util::max_source_size) [[unlikely]]
+      {
+         lexer.tokenize_all<Util::TriviaMode::Skip>(ast.tokens);
+         lexed_end_of_file = true;
+      };
+
+      while (ast.tokens.size() <= current + distance && !lexed_end_of_file)
+      {
+         auto token = lexer.process_next_token<Util::TriviaMode::Skip>();
+         ast.tokens.push_back_from(token,lexer.get_context());
+         lexed_end_of_file = token.token_type == TokenType::EndOfFile;
+
+         //past the end of the source the EndOfFile token has been consumed already, whatever mode the lexer was left in.
+         //The parser still stops on an EndOfFile token, so one is added at the end
+         const auto& lexed_source = lexer.get_context().source;
+         if (!lexed_end_of_file && lexed_source.index > lexed_source.size())
+         {
+            Util::TokenGeneric end_of_file;
+            end_of_file.token_type = TokenType::EndOfFile;
+            end_of_file.offset = lexed_source.size();
+            end_of_file.length = 0;
+            ast.tokens.push_back_from(end_of_file,lexer.get_context());
+            lexed_end_of_file = true;
+         };
+      };
+
+      return std::min(current + distance,ast.tokens.size() - 1);
+   };
+
+   TokenType Parser::peek_type(size_t distance)
+   {
+      return ast.tokens.type(token_at(distance));
+   };
+
+   bool Parser::is_symbol(SymbolKind symbol_kind, size_t distance)
+   {
+      auto token_index = token_at(distance);
+      return ast.tokens.type(token_index) == TokenType::Symbol && ast.tokens.symbol(token_index) == symbol_kind;
+   };
+
+   bool Parser::is_previous_symbol(SymbolKind symbol_kind)
+   {
+      return current > 0 && ast.tokens.type(current - 1) == TokenType::Symbol && ast.tokens.symbol(current - 1) == symbol_kind;
+   };
+
+   bool Parser::is_keyword(Keyword keyword, size_t distance)
+   {
+      auto token_index = token_at(distance);
+      return ast.tokens.type(token_index) == TokenType::Identifier && ast.tokens.keyword(token_index) == keyword;
+   };
+
+   //contextual words (buffer, copy, export, as, LUA) are plain identifiers to the lexer, interned once so checking one is an atom compare
+   bool Parser::is_word(Util::Atom word, size_t distance)
+   {
+      auto token_index = token_at(distance);
+      return ast.tokens.type(token_index) == TokenType::Identifier && ast.tokens.atom(token_index) == word;
+   };
+
+   bool Parser::is_at_new_line()
+   {
+      return ast.tokens.flags(token_at(0)) & Util::TokenFlags::PrecededByNewLine;
+   };
+
+   bool Parser::is_at_statement_end()
+   {
+      return is_symbol(SymbolKind::SEMICOLON) || is_symbol(SymbolKind::RBRACE) || peek_type() == TokenType::EndOfFile || is_at_new_line();
+   };
+
+   uint32_t Parser::advance()
+   {
+      auto token_index = token_at(0);
+      if (ast.tokens.type(token_index) != TokenType::EndOfFile)
+      {
+         current++;
+      };
+      return static_cast<uint32_t>(token_index);
+   };
+
+   bool Parser::accept(SymbolKind symbol_kind)
+   {
+      if (!is_symbol(symbol_kind))
+      {
+         return false;
+      };
+      advance();
+      return true;
+   };
+
+   bool Parser::expect(SymbolKind symbol_kind)
+   {
+      if (accept(symbol_kind))
+      {
+         return true;
+      };
+      record_error(ParseErrorCode::ExpectedSymbol,symbol_kind);
+      return false;
+   };
+
+   uint32_t Parser::expect_identifier()
+   {
+      if (peek_type() == TokenType::Identifier)
+      {
+         return advance();
+      };
+      record_error(ParseErrorCode::ExpectedIdentifier);
+      return static_cast<uint32_t>(token_at(0));
+   };
+
+   //a statement ends at a ';', or without one where the next token starts a new line, closes the block or ends the file
+   void Parser::expect_terminator()
+   {
+      if (accept(SymbolKind::SEMICOLON))
+      {
+         return;
+      };
+
+      if (!is_at_statement_end())
+      {
+         record_error(ParseErrorCode::ExpectedTerminator);
+      };
+   };
+
+   //only the first error at a token is kept, the rest are follow ups of it
+   void Parser::record_error(ParseErrorCode error_code, SymbolKind expected_symbol)
+   {
+      auto token_index = static_cast<uint32_t>(token_at(0));
+      if (!ast.errors.empty() && ast.errors.back().token == token_index)
+      {
+         return;
+      };
+      ast.errors.push_back(ParseError{error_code,token_index,expected_symbol});
+   };
+
+   Parser::NodeStart Parser::start_node()
+   {
+      return NodeStart{static_cast<uint32_t>(child_stack.size()),static_cast<uint32_t>(token_at(0))};
+   };
+
+   //for nodes whose first child was parsed before it was known to be one, like the left side of a binary operator
+   Parser::NodeStart Parser::start_node_at(NodeIndex first_child)
+   {
+      return NodeStart{static_cast<uint32_t>(child_stack.size()),ast.nodes.span(first_child).first};
+   };
+
+   //no_node is an expression that was missing, there is nothing to add for it
+   void Parser::add_child(NodeIndex child)
+   {
+      if (child != no_node)
+      {
+         child_stack.push_back(child);
+      };
+   };
+
+   //the node spans up to the last token consumed since start. A node nothing was consumed for, like a capture or parameter
+   //that is only an error, is left out the same way a missing expression is, it would span a token that isn't its own.
+   //Only the Module of an empty file is kept, on its EndOfFile token
+   NodeIndex Parser::finish_node(const NodeStart& start, NodeKind kind, uint32_t token, uint16_t flags, SymbolKind symbol)
+   {
+      if (current == start.first_token && kind != NodeKind::Module)
+      {
+         child_stack.resize(start.child_mark);
+         return no_node;
+      };
+
+      auto last_token = current > start.first_token ? static_cast<uint32_t>(current - 1) : start.first_token;
+      auto children = std::span<const NodeIndex>(child_stack.data() + start.child_mark,child_stack.size() - start.child_mark);
+
+      auto node = ast.nodes.push_back(kind,symbol,flags,token,TokenSpan{start.first_token,last_token},children);
+      child_stack.resize(start.child_mark);
+      return node;
+   };
+
+   NodeIndex Parser::make_leaf(NodeKind kind, uint32_t token, uint16_t flags)
+   {
+      return ast.nodes.push_back(kind,SymbolKind::UNKNOWN,flags,token,TokenSpan{token,token},{});
+   };
+
+   //skips to where the next statement most likely starts: past a ';', or up to a '}' or the first token on a new line.
+   //The current token is always skipped, this is only called where it couldn't be used
+   void Parser::synchronize()
+   {
+      while (peek_type() != TokenType::EndOfFile)
+      {
+         if (accept(SymbolKind::SEMICOLON))
+         {
+            return;
+         };
+
+         advance();
+         if (is_symbol(SymbolKind::RBRACE) || is_at_new_line())
+         {
+            return;
+         };
+      };
+   };
+
+   //a statement nothing could be parsed from, it covers everything up to the next synchronization point
+   NodeIndex Parser::make_error_node()
+   {
+      auto start = start_node();
+      record_error(ParseErrorCode::UnexpectedToken);
+      synchronize();
+      return finish_node(start,NodeKind::Error,start.first_token);
+   };
+
+   bool Parser::is_qualifier(size_t distance)
+   {
+      return is_keyword(Keyword::Extern,distance) ||
+         is_keyword(Keyword::Virtual,distance) ||
+         is_keyword(Keyword::Const,distance) ||
+         is_keyword(Keyword::Static,distance) ||
+         is_keyword(Keyword::Inline,distance) ||
+         is_word(words.buffer,distance);
+   };
+
+   uint16_t Parser::parse_qualifiers()
+   {
+      uint16_t flags = 0;
+      while (is_qualifier(0))
+      {
+         auto token_index = advance();
+         switch (ast.tokens.keyword(token_index))
+         {
+         case Keyword::Extern: flags |= NodeFlags::Extern; break;
+         case Keyword::Virtual: flags |= NodeFlags::Virtual; break;
+         case Keyword::Const: flags |= NodeFlags::Const; break;
+         case Keyword::Static: flags |= NodeFlags::Static; break;
+         case Keyword::Inline: flags |= NodeFlags::Inline; break;
+         default: flags |= NodeFlags::Buffer; break;
+         };
+      };
+      return flags;
+   };
+
+   bool Parser::is_type_name(size_t distance)
+   {
+      auto token_index = token_at(distance);
+      if (ast.tokens.type(token_index) != TokenType::Identifier)
+      {
+         return false;
+      };
+      auto keyword = ast.tokens.keyword(token_index);
+      return keyword == Keyword::Unknown || keyword == Keyword::Auto;
+   };
+
+   //type name, or type & name / type * name followed by something only a declaration has there
+   bool Parser::looks_like_declaration()
+   {
+      if (is_qualifier(0))
+      {
+         return true;
+      };
+
+      if (!is_type_name(0))
+      {
+         return false;
+      };
+
+      if (is_type_name(1))
+      {
+         return true;
+      };
+
+      if (!(is_symbol(SymbolKind::BIT_AND,1) || is_symbol(SymbolKind::STAR,1)) || !is_type_name(2))
+      {
+         return false;
+      };
+
+      return is_symbol(SymbolKind::EQUAL,3) ||
+         is_symbol(SymbolKind::SEMICOLON,3) ||
+         is_symbol(SymbolKind::COMMA,3) ||
+         is_symbol(SymbolKind::RPAREN,3) ||
+         is_symbol(SymbolKind::LPAREN,3) ||
+         (ast.tokens.flags(token_at(3)) & Util::TokenFlags::PrecededByNewLine);
+   };
+
+   NodeIndex Parser::parse_statement()
+   {
+      auto first_token = current;
+      auto first_error = ast.errors.size();
+      auto first_node = ast.nodes.size();
+      auto child_mark = child_stack.size();
+      NodeIndex statement;
+
+      if (is_symbol(SymbolKind::SEMICOLON))
+      {
+         statement = make_leaf(NodeKind::Empty,advance());
+      } else if (is_symbol(SymbolKind::LBRACE)) {
+         statement = parse_block();
+      } else if (is_symbol(SymbolKind::AT_SIGN)) {
+         statement = parse_lua_statement();
+      } else if (is_keyword(Keyword::If)) {
+         statement = parse_if();
+      } else if (is_keyword(Keyword::For)) {
+         statement = parse_for();
+      } else if (is_keyword(Keyword::While)) {
+         statement = parse_while();
+      } else if (is_keyword(Keyword::Return)) {
+         statement = parse_return();
+      } else if (is_keyword(Keyword::Break) || is_keyword(Keyword::Continue)) {
+         auto kind = is_keyword(Keyword::Break) ? NodeKind::Break : NodeKind::Continue;
+         statement = make_leaf(kind,advance());
+         expect_terminator();
+      } else if (looks_like_declaration()) {
+         statement = parse_declaration();
+      } else {
+         statement = parse_expression_statement();
+      };
+
+      //nothing could be parsed, whatever the attempt left in the pool is dropped for the Error node that replaces it
+      if (current == first_token && peek_type() != TokenType::EndOfFile)
+      {
+         ast.nodes.truncate(first_node);
+         child_stack.resize(child_mark);
+         return make_error_node();
+      };
+
+      //a statement that went wrong somewhere in the middle of a line leaves the rest of the line to synchronize(),
+      //otherwise every leftover token would start a broken statement of its own
+      if (ast.errors.size() > first_error && !is_previous_symbol(SymbolKind::SEMICOLON) && !is_previous_symbol(SymbolKind::RBRACE) && !is_at_statement_end())
+      {
+         synchronize();
+      };
+
+      return statement;
+   };
+
+   NodeIndex Parser::parse_block()
+   {
+      auto start = start_node();
+      auto open_token = static_cast<uint32_t>(token_at(0));
+
+      expect(SymbolKind::LBRACE);
+      while (!is_symbol(SymbolKind::RBRACE) && peek_type() != TokenType::EndOfFile)
+      {
+         add_child(parse_statement());
+      };
+      expect(SymbolKind::RBRACE);
+
+      return finish_node(start,NodeKind::Block,open_token);
+   };
+
+   //qualifiers type name, then either a parameter list and a body (or nothing, for a prototype) or an optional initializer
+   NodeIndex Parser::parse_declaration(bool terminated)
+   {
+      auto start = start_node();
+      auto flags = parse_qualifiers();
+
+      add_child(parse_type());
+      auto name = expect_identifier();
+
+      if (is_symbol(SymbolKind::LPAREN))
+      {
+         add_child(parse_parameter_list());
+
+         if (is_symbol(SymbolKind::LBRACE))
+         {
+            add_child(parse_block());
+            return finish_node(start,NodeKind::FunctionDeclaration,name,flags);
+         };
+
+         if (terminated)
+         {
+            expect_terminator();
+         };
+         return finish_node(start,NodeKind::FunctionDeclaration,name,flags);
+      };
+
+      if (accept(SymbolKind::EQUAL))
+      {
+         add_child(parse_expression());
+      };
+
+      if (terminated)
+      {
+         expect_terminator();
+      };
+      return finish_node(start,NodeKind::VariableDeclaration,name,flags);
+   };
+
+   NodeIndex Parser::parse_type()
+   {
+      if (!is_type_name(0))
+      {
+         record_error(ParseErrorCode::ExpectedIdentifier);
+         return no_node;
+      };
+
+      auto start = start_node();
+      auto name = advance();
+      uint16_t flags = 0;
+
+      while (true)
+      {
+         if (accept(SymbolKind::BIT_AND))
+         {
+            flags |= NodeFlags::Reference;
+         } else if (accept(SymbolKind::STAR)) {
+            flags |= NodeFlags::Pointer;
+         } else {
+            break;
+         };
+      };
+
+      return finish_node(start,NodeKind::Type,name,flags);
+   };
+
+   NodeIndex Parser::parse_parameter_list()
+   {
+      auto start = start_node();
+      auto open_token = static_cast<uint32_t>(token_at(0));
+
+      expect(SymbolKind::LPAREN);
+      if (!accept(SymbolKind::RPAREN))
+      {
+         do
+         {
+            auto parameter_start = start_node();
+            auto flags = parse_qualifiers();
+
+            add_child(parse_type());
+            add_child(finish_node(parameter_start,NodeKind::Parameter,expect_identifier(),flags));
+         } while (accept(SymbolKind::COMMA));
+
+         expect(SymbolKind::RPAREN);
+      };
+
+      return finish_node(start,NodeKind::ParameterList,open_token);
+   };
+
+   //a clause of for that may be left out. A missing one is an Empty node on the 'for', '(' or ';' in front of it, those belong
+   //to the for itself. Without that token, after a missing ';', an empty clause gets no node
+   NodeIndex Parser::parse_empty_or_expression(bool is_empty, bool is_separated)
+   {
+      if (is_empty)
+      {
+         return is_separated ? make_leaf(NodeKind::Empty,static_cast<uint32_t>(current - 1)) : no_node;
+      };
+      return parse_expression();
+   };
+
+   NodeIndex Parser::parse_if()
+   {
+      auto start = start_node();
+      auto if_token = advance();
+
+      add_child(parse_expression());
+      add_child(parse_statement());
+
+      if (is_keyword(Keyword::Else))
+      {
+         advance();
+         add_child(parse_statement());
+      };
+
+      return finish_node(start,NodeKind::If,if_token);
+   };
+
+   //for init; condition; step body, with or without parentheses around the clauses.
+   //Always has four children, a missing clause is an Empty node
+   NodeIndex Parser::parse_for()
+   {
+      auto start = start_node();
+      auto for_token = advance();
+
+      bool parenthesized = accept(SymbolKind::LPAREN);
+
+      if (!is_symbol(SymbolKind::SEMICOLON) && looks_like_declaration())
+      {
+         add_child(parse_declaration(false));
+      } else {
+         add_child(parse_empty_or_expression(is_symbol(SymbolKind::SEMICOLON),true));
+      };
+      auto is_separated = expect(SymbolKind::SEMICOLON);
+
+      add_child(parse_empty_or_expression(is_symbol(SymbolKind::SEMICOLON),is_separated));
+      is_separated = expect(SymbolKind::SEMICOLON);
+
+      add_child(parse_empty_or_expression(is_symbol(parenthesized ? SymbolKind::RPAREN : SymbolKind::LBRACE),is_separated));
+      if (parenthesized)
+      {
+         expect(SymbolKind::RPAREN);
+      };
+
+      add_child(parse_statement());
+      return finish_node(start,NodeKind::For,for_token);
+   };
+
+   NodeIndex Parser::parse_while()
+   {
+      auto start = start_node();
+      auto while_token = advance();
+
+      add_child(parse_expression());
+      add_child(parse_statement());
+
+      return finish_node(start,NodeKind::While,while_token);
+   };
+
+   NodeIndex Parser::parse_return()
+   {
+      auto start = start_node();
+      auto return_token = advance();
+
+      if (!is_at_statement_end())
+      {
+         add_child(parse_expression());
+      };
+      expect_terminator();
+
+      return finish_node(start,NodeKind::Return,return_token);
+   };
+
+   //@LUA [&reference, copy, copy name]{ lua } export [names] as [names]
+   NodeIndex Parser::parse_lua_statement()
+   {
+      auto start = start_node();
+      auto at_token = advance();
+
+      if (is_word(words.lua))
+      {
+         advance();
+      } else {
+         record_error(ParseErrorCode::ExpectedLua);
+      };
+
+      auto capture_list_start = start_node();
+      auto open_token = static_cast<uint32_t>(token_at(0));
+
+      //without its '[' there is no capture list, its node would span a token that isn't part of the statement
+      if (expect(SymbolKind::LBRACKET))
+      {
+         if (!accept(SymbolKind::RBRACKET))
+         {
+            do
+            {
+               auto capture_start = start_node();
+               uint16_t flags = 0;
+
+               if (accept(SymbolKind::BIT_AND))
+               {
+                  flags = NodeFlags::Reference;
+               } else if (is_word(words.copy) && peek_type(1) == TokenType::Identifier) {
+                  advance();
+                  flags = NodeFlags::Copy;
+               };
+
+               add_child(finish_node(capture_start,NodeKind::Capture,expect_identifier(),flags));
+            } while (accept(SymbolKind::COMMA));
+
+            expect(SymbolKind::RBRACKET);
+         };
+         add_child(finish_node(capture_list_start,NodeKind::CaptureList,open_token));
+      };
+
+      if (peek_type() == TokenType::LuaBlock)
+      {
+         add_child(make_leaf(NodeKind::LuaCode,advance()));
+      } else if (peek_type() == TokenType::Error) {
+         //an unclosed block, the lexer has reported it already
+         record_error(ParseErrorCode::LexerError);
+         add_child(make_leaf(NodeKind::Error,advance()));
+      } else {
+         record_error(ParseErrorCode::ExpectedLua);
+      };
+
+      if (is_word(words.export_names))
+      {
+         auto export_start = start_node();
+         auto export_token = advance();
+
+         add_child(parse_name_list());
+         if (is_word(words.as))
+         {
+            advance();
+         } else {
+            record_error(ParseErrorCode::ExpectedIdentifier);
+         };
+         add_child(parse_name_list());
+
+         add_child(finish_node(export_start,NodeKind::Export,export_token));
+      };
+
+      expect_terminator();
+      return finish_node(start,NodeKind::LuaStatement,at_token);
+   };
+
+   NodeIndex Parser::parse_name_list()
+   {
+      auto start = start_node();
+      auto open_token = static_cast<uint32_t>(token_at(0));
+
+      if (expect(SymbolKind::LBRACKET) && !accept(SymbolKind::RBRACKET))
+      {
+         do
+         {
+            if (peek_type() == TokenType::Identifier)
+            {
+               add_child(make_leaf(NodeKind::Identifier,advance()));
+            } else {
+               record_error(ParseErrorCode::ExpectedIdentifier);
+            };
+         } while (accept(SymbolKind::COMMA));
+
+         expect(SymbolKind::RBRACKET);
+      };
+
+      return finish_node(start,NodeKind::NameList,open_token);
+   };
+
+   NodeIndex Parser::parse_expression_statement()
+   {
+      auto start = start_node();
+
+      add_child(parse_expression());
+      expect_terminator();
+
+      return finish_node(start,NodeKind::ExpressionStatement,start.first_token);
+   };
+
+   NodeIndex Parser::parse_expression(uint8_t min_binding_power)
+   {
+      auto left = parse_prefix();
+      if (left == no_node)
+      {
+         return no_node;
+      };
+
+      while (peek_type() == TokenType::Symbol)
+      {
+         auto symbol = ast.tokens.symbol(token_at(0));
+         auto binding_power = infix_binding_power(symbol);
+         if (binding_power <= min_binding_power)
+         {
+            break;
+         };
+
+         if (binding_power == postfix_power)
+         {
+            //without semicolons f \n (x) and a \n ++b are two statements, member access may still continue on the next line
+            if (is_at_new_line() && symbol != SymbolKind::DOT && symbol != SymbolKind::ARROW)
+            {
+               break;
+            };
+            left = parse_postfix(left,symbol);
+            continue;
+         };
+
+         auto start = start_node_at(left);
+         auto operator_token = advance();
+         add_child(left);
+
+         if (binding_power == assignment_power)
+         {
+            add_child(parse_expression(assignment_power - 1));
+            left = finish_node(start,NodeKind::Assignment,operator_token,0,symbol);
+         } else if (binding_power == conditional_power) {
+            add_child(parse_expression());
+            expect(SymbolKind::COLON);
+            add_child(parse_expression(assignment_power - 1));
+            left = finish_node(start,NodeKind::Conditional,operator_token,0,symbol);
+         } else {
+            add_child(parse_expression(binding_power));
+            left = finish_node(start,NodeKind::Binary,operator_token,0,symbol);
+         };
+      };
+
+      return left;
+   };
+
+   NodeIndex Parser::parse_postfix(NodeIndex operand, SymbolKind symbol)
+   {
+      auto start = start_node_at(operand);
+      auto operator_token = advance();
+      add_child(operand);
+
+      switch (symbol)
+      {
+      case SymbolKind::LPAREN:
+         if (!accept(SymbolKind::RPAREN))
+         {
+            do
+            {
+               add_child(parse_expression());
+            } while (accept(SymbolKind::COMMA));
+            expect(SymbolKind::RPAREN);
+         };
+         return finish_node(start,NodeKind::Call,operator_token);
+      case SymbolKind::LBRACKET:
+         add_child(parse_expression());
+         expect(SymbolKind::RBRACKET);
+         return finish_node(start,NodeKind::Index,operator_token);
+      case SymbolKind::DOT:
+      case SymbolKind::ARROW:
+      {
+         auto name = expect_identifier();
+         return finish_node(start,NodeKind::Member,name,0,symbol);
+      };
+      default:
+         return finish_node(start,NodeKind::Postfix,operator_token,0,symbol);
+      };
+   };
+
+   NodeIndex Parser::parse_prefix()
+   {
+      auto token_index = static_cast<uint32_t>(token_at(0));
+
+      switch (ast.tokens.type(token_index))
+      {
+      case TokenType::Identifier:
+         switch (ast.tokens.keyword(token_index))
+         {
+         case Keyword::True:
+         case Keyword::False:
+            return make_leaf(NodeKind::BooleanLiteral,advance());
+         case Keyword::Nil:
+            return make_leaf(NodeKind::NullLiteral,advance());
+         case Keyword::Unknown:
+         case Keyword::Sizeof:
+            break;
+         default:
+            return make_missing_expression();
+         };
+
+         if (is_symbol(SymbolKind::LESS,1))
+         {
+            auto text = ast.token_text(token_index);
+            if (text == "static_cast" || text == "reinterpret_cast" || text == "const_cast" || text == "dynamic_cast")
+            {
+               return parse_cast();
+            };
+         };
+         return make_leaf(NodeKind::Identifier,advance());
+      case TokenType::Numeric:
+         return make_leaf(NodeKind::NumberLiteral,advance());
+      case TokenType::String:
+         return make_leaf(NodeKind::StringLiteral,advance());
+      case TokenType::Char:
+         return make_leaf(NodeKind::CharLiteral,advance());
+      case TokenType::Error:
+         record_error(ParseErrorCode::LexerError);
+         return make_leaf(NodeKind::Error,advance());
+      case TokenType::Symbol:
+      {
+         auto symbol = ast.tokens.symbol(token_index);
+         if (symbol == SymbolKind::LPAREN)
+         {
+            advance();
+            auto expression = parse_expression();
+            expect(SymbolKind::RPAREN);
+            return expression;
+         };
+
+         if (is_prefix_operator(symbol))
+         {
+            auto start = start_node();
+            auto operator_token = advance();
+            add_child(parse_expression(prefix_power));
+            return finish_node(start,NodeKind::Unary,operator_token,0,symbol);
+         };
+         break;
+      };
+      default:
+         break;
+      };
+
+      return make_missing_expression();
+   };
+
+   //the Error leaf takes the token along, unless a statement or an enclosing bracket or list ends there.
+   //That token is left to the caller and the missing expression gets no node, so nodes never reach past their parent
+   //and siblings never share a token
+   NodeIndex Parser::make_missing_expression()
+   {
+      record_error(ParseErrorCode::ExpectedExpression);
+
+      if (is_at_statement_end() || is_symbol(SymbolKind::RPAREN) || is_symbol(SymbolKind::RBRACKET) || is_symbol(SymbolKind::COMMA) || is_symbol(SymbolKind::COLON) || is_symbol(SymbolKind::LBRACE))
+      {
+         return no_node;
+      };
+      return make_leaf(NodeKind::Error,advance());
+   };
+
+   //static_cast<type>(expression) and the other named casts
+   NodeIndex Parser::parse_cast()
+   {
+      auto start = start_node();
+      auto cast_token = advance();
+
+      expect(SymbolKind::LESS);
+      add_child(parse_type());
+      expect(SymbolKind::GREATER);
+      expect(SymbolKind::LPAREN);
+      add_child(parse_expression());
+      expect(SymbolKind::RPAREN);
+
+      return finish_node(start,NodeKind::Cast,cast_token);
+   };
+
+   Ast Parser::parse()
+   {
+      auto start = start_node();
+
+      while (peek_type() != TokenType::EndOfFile)
+      {
+         add_child(parse_statement());
+      };
+
+      ast.root = finish_node(start,NodeKind::Module,start.first_token);
+      return std::move(ast);
+   };
+
+   std::string dump(const Ast& ast, NodeIndex node_index)
+   {
+      const auto& nodes = ast.nodes;
+      auto flags = nodes.flags(node_index);
+
+      std::string text = "(";
+      text += node_kind_to_string(nodes.kind(node_index));
+
+      switch (nodes.kind(node_index))
+      {
+      case NodeKind::Type:
+         text += " ";
+         text += ast.text(node_index);
+         text += flags & NodeFlags::Reference ? "&" : "";
+         text += flags & NodeFlags::Pointer ? "*" : "";
+         break;
+      case NodeKind::Capture:
+         text += flags & NodeFlags::Copy ? " copy " : " ";
+         text += flags & NodeFlags::Reference ? "&" : "";
+         text += ast.text(node_index);
+         break;
+      case NodeKind::VariableDeclaration:
+      case NodeKind::FunctionDeclaration:
+      case NodeKind::Parameter:
+      case NodeKind::Identifier:
+      case NodeKind::NumberLiteral:
+      case NodeKind::StringLiteral:
+      case NodeKind::CharLiteral:
+      case NodeKind::BooleanLiteral:
+      case NodeKind::Unary:
+      case NodeKind::Postfix:
+      case NodeKind::Binary:
+      case NodeKind::Assignment:
+      case NodeKind::Member:
+      case NodeKind::Cast:
+         text += " ";
+         text += ast.text(node_index);
+         break;
+      default:
+         break;
+      };
+
+      for (auto child_index : nodes.children(node_index))
+      {
+         text += " ";
+         text += dump(ast,child_index);
+      };
+
+      text += ")";
+      return text;
+   };
+};
@@ -1,5 +1,95 @@
+#pragma once
+
+#include <parser/ast.hpp>
 #include <lexer/lexer.hpp>
+#include <arena.hpp>
+
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+namespace ASTParser {
+
+    //Recursive descent for statements and declarations, Pratt parsing over SymbolKind for expressions.
+    //Tokens are pulled from a trivia skipping lexer as the parser goes, so the source is lexed once, in the same pass.
+    //Semicolons are optional where the next token starts on a new line, before a '}' and at the end of the file.
+    class Parser {
+        private:
+        Util::Source source;
+        Util::Lexer lexer;
+        Ast ast;
+        size_t current = 0;
+        bool lexed_end_of_file = false;
+
+        struct Words {
+            Util::Atom buffer = Util::no_atom;
+            Util::Atom copy = Util::no_atom;
+            Util::Atom export_names = Util::no_atom;
+            Util::Atom as = Util::no_atom;
+            Util::Atom lua = Util::no_atom;
+        } words;
+
+        //children of the nodes being parsed, a finished node moves its run from the top into the pool
+        std::vector<NodeIndex> child_stack;
+
+        struct NodeStart {
+            uint32_t child_mark;
+            uint32_t first_token;
+        };
+
+        Util::TokenType peek_type(size_t distance = 0);
+        bool is_symbol(SymbolClassifier::SymbolKind symbol_kind, size_t distance = 0);
+        bool is_previous_symbol(SymbolClassifier::SymbolKind symbol_kind);
+        bool is_keyword(KeywordClassifier::Keyword keyword, size_t distance = 0);
+        bool is_word(Util::Atom word, size_t distance = 0);
+        bool is_at_new_line();
+        bool is_at_statement_end();
+        size_t token_at(size_t distance);
+        uint32_t advance();
+        bool accept(SymbolClassifier::SymbolKind symbol_kind);
+        bool expect(SymbolClassifier::SymbolKind symbol_kind);
+        uint32_t expect_identifier();
+        void expect_terminator();
+        void record_error(ParseErrorCode error_code, SymbolClassifier::SymbolKind expected_symbol = SymbolClassifier::SymbolKind::UNKNOWN);
+
+        NodeStart start_node();
+        NodeStart start_node_at(NodeIndex first_child);
+        void add_child(NodeIndex child);
+        NodeIndex finish_node(const NodeStart& start, NodeKind kind, uint32_t token, uint16_t flags = 0, SymbolClassifier::SymbolKind symbol = SymbolClassifier::SymbolKind::UNKNOWN);
+        NodeIndex make_leaf(NodeKind kind, uint32_t token, uint16_t flags = 0);
+        void synchronize();
+        NodeIndex make_error_node();
+        NodeIndex make_missing_expression();
+
+        uint16_t parse_qualifiers();
+        bool is_qualifier(size_t distance);
+        bool is_type_name(size_t distance);
+        bool looks_like_declaration();
+
+        NodeIndex parse_statement();
+        NodeIndex parse_block();
+        NodeIndex parse_declaration(bool terminated = true);
+        NodeIndex parse_type();
+        NodeIndex parse_parameter_list();
+        NodeIndex parse_empty_or_expression(bool is_empty, bool is_separated);
+        NodeIndex parse_if();
+        NodeIndex parse_for();
+        NodeIndex parse_while();
+        NodeIndex parse_return();
+        NodeIndex parse_lua_statement();
+        NodeIndex parse_name_list();
+        NodeIndex parse_expression_statement();
+
+        NodeIndex parse_expression(uint8_t min_binding_power = 0);
+        NodeIndex parse_prefix();
+        NodeIndex parse_postfix(NodeIndex operand, SymbolClassifier::SymbolKind symbol);
+        NodeIndex parse_cast();
+
+        public:
+        //nodes are allocated from arena, which has to outlive the returned Ast, as does source.
+        //Identifiers are interned into interner, share one between files so their atoms can be compared
+        Parser(Util::Source& source, Util::Arena& arena, Util::Interner& interner);
 
-namespace ASTParser{
-    
-};
\ No newline at end of file
+        Ast parse();
+    };
+};
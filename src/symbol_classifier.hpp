@@ -1,7 +1,7 @@
 #pragma once
 
-#include <string>
-#include <unordered_map>
+#include <array>
+#include <string_view>
 #include <stdint.h>
 
 namespace SymbolClassifier {
@@ -64,7 +64,12 @@ enum class SymbolKind: uint8_t {
     UNKNOWN
 };
 
-std::unordered_map<std::string, SymbolKind> normalized_symbols = {
+struct SymbolEntry {
+    std::string_view symbol;
+    SymbolKind kind;
+};
+
+inline constexpr SymbolEntry normalized_symbols[] = {
         {"++", SymbolKind::DOUBLE_PLUS},        
         {"+=", SymbolKind::PLUS_EQUAL},
         {"--", SymbolKind::DOUBLE_MINUS},       
@@ -120,28 +125,131 @@ std::unordered_map<std::string, SymbolKind> normalized_symbols = {
         {"@", SymbolKind::AT_SIGN}
     };
 
-    SymbolKind get_symbol_from_buffer_fragment(const char* buffer_fragment, size_t length)
-    {
-        if (length == 0 || buffer_fragment == nullptr)
-            return SymbolKind::UNKNOWN; 
+    //Every symbol is at most 3 bytes long, so the matcher is a tiny trie built at compile time:
+    //the root level is a 256 entry table indexed by the first character, deeper levels are short sibling lists.
+    namespace SymbolTrie {
+        using NodeIndex = uint8_t;
+
+        //node 0 is the root, it can never be somebody's child so it doubles as "no transition"
+        inline constexpr NodeIndex root_node = 0;
+        inline constexpr size_t max_nodes = 64;
+
+        struct Node {
+            SymbolKind kind = SymbolKind::UNKNOWN;
+            unsigned char character = 0;
+            NodeIndex first_child = root_node;
+            NodeIndex next_sibling = root_node;
+        };
+
+        struct Trie {
+            std::array<NodeIndex,256> root_children {};
+            std::array<Node,max_nodes> nodes {};
+            size_t node_count = 1;
+        };
+
+        constexpr NodeIndex find_child(const Trie& trie, NodeIndex node, unsigned char character)
+        {
+            if (node == root_node)
+            {
+                return trie.root_children[character];
+            };
+
+            for (auto child = trie.nodes[node].first_child; child != root_node; child = trie.nodes[child].next_sibling)
+            {
+                if (trie.nodes[child].character == character)
+                {
+                    return child;
+                };
+            };
+
+            return root_node;
+        };
 
-        for (const auto& [symbol_str, kind] : normalized_symbols)
+        constexpr Trie build_trie()
         {
-            if (symbol_str.size() != length)
-                continue;
+            Trie trie;
 
-            bool match = true;
-            for (size_t i = 0; i < length; ++i)
+            for (const auto& [symbol_str, kind] : normalized_symbols)
             {
-                if (buffer_fragment[i] != symbol_str[i])
+                NodeIndex node = root_node;
+
+                for (auto symbol_char : symbol_str)
                 {
-                    match = false;
-                    break;
-                }
-            }
-            if (match)
-                return kind;
-            }   
+                    auto character = static_cast<unsigned char>(symbol_char);
+                    auto child = find_child(trie, node, character);
+
+                    if (child == root_node)
+                    {
+                        if (trie.node_count == max_nodes)
+                        {
+                            throw "SymbolTrie: max_nodes is too small for normalized_symbols";
+                        };
+
+                        child = static_cast<NodeIndex>(trie.node_count++);
+                        trie.nodes[child].character = character;
+
+                        if (node == root_node)
+                        {
+                            trie.root_children[character] = child;
+                        } else {
+                            trie.nodes[child].next_sibling = trie.nodes[node].first_child;
+                            trie.nodes[node].first_child = child;
+                        };
+                    };
+
+                    node = child;
+                };
+
+                trie.nodes[node].kind = kind;
+            };
+
+            return trie;
+        };
+
+        inline constexpr Trie trie = build_trie();
+
+        constexpr bool every_prefix_is_symbol()
+        {
+            for (size_t node = 1; node < trie.node_count; node++)
+            {
+                if (trie.nodes[node].kind == SymbolKind::UNKNOWN)
+                {
+                    return false;
+                };
+            };
+            return true;
+        };
+
+        //the lexer stops at the first character that does not extend the match and never backtracks,
+        //which is only correct while "<<", "->", "&&" and friends keep having their prefixes as symbols too
+        static_assert(every_prefix_is_symbol(), "every prefix of a symbol has to be a symbol itself");
+
+        constexpr NodeIndex advance(NodeIndex node, unsigned char character)
+        {
+            return find_child(trie, node, character);
+        };
+
+        constexpr SymbolKind kind_of(NodeIndex node)
+        {
+            return trie.nodes[node].kind;
+        };
+    };
+
+    constexpr SymbolKind get_symbol_from_buffer_fragment(const char* buffer_fragment, size_t length)
+    {
+        if (length == 0 || buffer_fragment == nullptr)
             return SymbolKind::UNKNOWN; 
+
+        auto node = SymbolTrie::root_node;
+        for (size_t i = 0; i < length; ++i)
+        {
+            node = SymbolTrie::advance(node, static_cast<unsigned char>(buffer_fragment[i]));
+            if (node == SymbolTrie::root_node)
+                return SymbolKind::UNKNOWN;
         }
+        return SymbolTrie::kind_of(node);
+    }
+
+    static_assert(get_symbol_from_buffer_fragment("<<=", 3) == SymbolKind::BIT_LSHIFT_EQUAL);
+    static_assert(get_symbol_from_buffer_fragment("=<", 2) == SymbolKind::UNKNOWN);
 }
\ No newline at end of file
@@ -1,2 +1,8 @@
 #include <test.cpp>
-#include <lexer/lexer.cpp>
\ No newline at end of file
+#include <lexer/lexer.cpp>
+#include <lexer/parallel_lexer.cpp>
+#include <lexer/incremental_lexer.cpp>
+#include <lexer/streaming_lexer.cpp>
+#include <driver/lex_driver.cpp>
+#include <parser/parser.cpp>
+#include <diagnostics/diagnostics.cpp>
\ No newline at end of file
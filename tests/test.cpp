@@ -1,8 +1,29 @@
 #include <lexer/lexer.hpp>
+#include <lexer/token_stream.hpp>
+#include <lexer/parallel_lexer.hpp>
+#include <lexer/incremental_lexer.hpp>
+#include <lexer/streaming_lexer.hpp>
+#include <lexer/scanner.hpp>
+#include <driver/lex_driver.hpp>
+#include <parser/parser.hpp>
+#include <diagnostics/diagnostics.hpp>
+#include <lexer/line_index.hpp>
 
 #include <iostream>
 #include <string>
 #include <cassert>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <ranges>
+#include <thread>
+#include <algorithm>
+
+#if defined(__linux__)
+    #include <unistd.h>
+#else
+    #include <process.h>
+#endif
 
 template<size_t TokenCount>
 struct Test {
@@ -15,31 +36,1114 @@ struct Test {
     Util::ErrorCode expected_error;
 };
 
-template<size_t TokenCount>
-void run_test(const Test<TokenCount>& test)
+template<size_t TokenCount>
+void run_test(const Test<TokenCount>& test)
+{
+    std::cout << "[TEST] " << test.name << std::endl;
+
+    Util::Source source(
+        reinterpret_cast<unsigned char*>(const_cast<char*>(test.input)),
+        std::strlen(test.input)
+    );
+
+    Util::Lexer lexer(source);
+
+    for (size_t i = 0; i < TokenCount; ++i)
+    {
+        auto token = lexer.process_next_token();
+
+        assert(token.token_type == test.expected_types[i]);
+        assert(token.offset == test.expected_offsets[i]);
+        assert(token.length == test.expected_lengths[i]);
+
+        if (token.token_type == Util::TokenType::Error)
+        {
+            const auto& error = lexer.get_context().errors[token.payload_index];
+            assert(error.offset == token.offset && error.length == token.length);
+        }
+    }
+
+    if (test.expect_error)
+    {
+        assert(lexer.get_last_error().error_code == test.expected_error);
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_batch_test(const char* name, const char* input)
+{
+    std::cout << "[TEST] " << name << std::endl;
+
+    Util::Source source(
+        reinterpret_cast<unsigned char*>(const_cast<char*>(input)),
+        std::strlen(input)
+    );
+
+    Util::PaddedSource padded_input(input);
+    Util::Source padded_source = padded_input.view();
+
+    Util::Lexer single_lexer(source);
+    Util::Lexer batch_lexer(padded_source);
+
+    std::vector<Util::TokenGeneric> tokens;
+    auto token_count = batch_lexer.tokenize_all(tokens);
+
+    assert(token_count == tokens.size());
+    assert(tokens.back().token_type == Util::TokenType::EndOfFile);
+
+    for (const auto& batch_token : tokens)
+    {
+        auto token = single_lexer.process_next_token();
+
+        assert(token.token_type == batch_token.token_type);
+        assert(token.offset == batch_token.offset);
+        assert(token.length == batch_token.length);
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_token_stream_test()
+{
+    std::cout << "[TEST] token stream" << std::endl;
+
+    std::string input = "x <<= 12; // ";
+    input.append(70000, '-');
+    input += "\nif";
+
+    Util::Source source(reinterpret_cast<unsigned char*>(input.data()), input.length());
+    Util::Lexer single_lexer(source);
+    Util::Lexer stream_lexer(source);
+
+    Util::TokenStream token_stream;
+    auto token_count = stream_lexer.tokenize_all(token_stream);
+
+    assert(token_count == 11);
+    for (size_t i = 0; i < token_stream.size(); ++i)
+    {
+        auto token = single_lexer.process_next_token();
+
+        assert(token_stream.type(i) == token.token_type);
+        assert(token_stream.offset(i) == token.offset);
+        assert(token_stream.length(i) == token.length);
+        assert(token_stream[i].length == token.length);
+    }
+
+    assert(token_stream.keyword(0) == KeywordClassifier::Keyword::Unknown);
+    assert(token_stream.symbol(2) == SymbolClassifier::SymbolKind::BIT_LSHIFT_EQUAL);
+    assert(token_stream.number(4).number_base == Util::NumberBase::Decimal);
+    assert(token_stream.symbol(5) == SymbolClassifier::SymbolKind::SEMICOLON);
+    assert(token_stream.length(7) == 70003);
+    assert(token_stream.keyword(9) == KeywordClassifier::Keyword::If);
+
+    //a source whose offsets don't fit 32 bits is refused up front, its bytes are never read
+    Util::Source oversized_source(reinterpret_cast<unsigned char*>(input.data()), Util::max_source_size + 1);
+    for (bool with_checkpoints : { false, true })
+    {
+        Util::TokenStream oversized_stream;
+        std::vector<Util::LexerCheckpoint> checkpoints;
+        Util::Lexer oversized_lexer(oversized_source);
+        auto oversized_count = with_checkpoints ?
+            oversized_lexer.tokenize_all(oversized_stream, checkpoints, 64) :
+            oversized_lexer.tokenize_all(oversized_stream);
+
+        assert(oversized_count == 2 && oversized_stream.size() == 2);
+        assert(oversized_stream.type(0) == Util::TokenType::Error);
+        assert(oversized_stream.error(0).error_code == Util::ErrorCode::SourceTooLarge);
+        assert(oversized_stream.type(1) == Util::TokenType::EndOfFile);
+        assert(oversized_stream.offset(1) == 0 && oversized_stream.length(1) == 0);
+    }
+
+    Util::Arena arena;
+    Util::Interner interner;
+    Util::Source oversized_parser_source(reinterpret_cast<unsigned char*>(input.data()), Util::max_source_size + 1);
+    auto oversized_ast = ASTParser::Parser(oversized_parser_source, arena, interner).parse();
+    assert(oversized_ast.tokens.size() == 2);
+    assert(oversized_ast.tokens.error(0).error_code == Util::ErrorCode::SourceTooLarge);
+
+    std::cout << "  OK\n";
+}
+
+//the process id and a counter keep parallel test runs, and repeated calls in one run, out of each other's files
+std::filesystem::path unique_temp_path(const std::string& stem, const std::string& extension = "")
+{
+    static size_t counter = 0;
+    return std::filesystem::temp_directory_path() / (stem + "_" + std::to_string(getpid()) + "_" + std::to_string(counter++) + extension);
+}
+
+void run_from_file_test(size_t file_size)
+{
+    std::cout << "[TEST] source from file of " << file_size << " bytes" << std::endl;
+
+    std::string input;
+    while (input.size() < file_size)
+    {
+        input += "int frame_count = 0; // comment\n";
+    }
+    input.resize(file_size, ' ');
+
+    auto path = unique_temp_path("clua_from_file_test", ".clua");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(input.data(), input.size());
+    }
+
+    auto file_input = Util::PaddedSource::from_file(path.string().c_str());
+    assert(file_input.has_value());
+    assert(file_input->size() == input.size());
+#if defined(__linux__)
+    assert(file_input->is_mapped());
+#endif
+    assert(std::memcmp(file_input->data(), input.data(), input.size()) == 0);
+
+    for (size_t i = 0; i < Util::PaddedSource::padding; ++i)
+    {
+        assert(file_input->data()[input.size() + i] == 0);
+    }
+
+    Util::Source file_source = file_input->view();
+    Util::Source memory_source(reinterpret_cast<unsigned char*>(input.data()), input.size());
+
+    std::vector<Util::TokenGeneric> file_tokens;
+    std::vector<Util::TokenGeneric> memory_tokens;
+    Util::Lexer(file_source).tokenize_all(file_tokens);
+    Util::Lexer(memory_source).tokenize_all(memory_tokens);
+
+    assert(file_tokens.size() == memory_tokens.size());
+    for (size_t i = 0; i < file_tokens.size(); ++i)
+    {
+        assert(file_tokens[i].token_type == memory_tokens[i].token_type);
+        assert(file_tokens[i].offset == memory_tokens[i].offset);
+        assert(file_tokens[i].length == memory_tokens[i].length);
+    }
+
+    file_input.reset();
+    std::filesystem::remove(path);
+
+    assert(!Util::PaddedSource::from_file(path.string().c_str()).has_value());
+
+    std::cout << "  OK\n";
+}
+
+void run_parallel_driver_test()
+{
+    std::cout << "[TEST] parallel lex driver" << std::endl;
+
+    auto directory = unique_temp_path("clua_driver_test");
+    std::filesystem::create_directories(directory);
+
+    std::vector<std::string> inputs = {
+        "int a = 0;\n",
+        "@LUA [&b]{ print(b) }\nfloat c = 0.5; // done\n",
+        "x $ y\n",
+    };
+
+    size_t expected_tokens = 0;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        std::ofstream(directory / ("module_" + std::to_string(i) + ".clua"), std::ios::binary) << inputs[i];
+
+        Util::Source source(reinterpret_cast<unsigned char*>(inputs[i].data()), inputs[i].size());
+        std::vector<Util::TokenGeneric> tokens;
+        expected_tokens += Util::Lexer(source).tokenize_all(tokens);
+    }
+
+    auto files = Driver::collect_clua_files({ directory.string() });
+    assert(files.size() == inputs.size());
+
+    auto report = Driver::lex_files(files, 2);
+    assert(report.worker_count == 2);
+    assert(report.unreadable_files == 0);
+    assert(report.total_tokens == expected_tokens);
+    assert(report.total_errors == 1);
+
+    std::filesystem::remove_all(directory);
+
+    std::cout << "  OK\n";
+}
+
+void run_luau_skipper_test()
+{
+    std::cout << "[TEST] lua block scanners against the scalar versions" << std::endl;
+
+    std::string input(4096, 'a');
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        //mostly long runs of lua code with every possible byte sprinkled in
+        input[i] = i % 29 == 0 ? static_cast<char>((i * 131 + i / 7) % 256) : "local x = y + 2 * z\n\t\xC3\xA9"[i % 23];
+    }
+    input.append(Util::PaddedSource::padding, '\0');
+
+    auto begin = reinterpret_cast<const unsigned char*>(input.data());
+    auto end = begin + input.size() - Util::PaddedSource::padding;
+
+    for (auto readable_end : { end, end + Util::PaddedSource::padding })
+    {
+        for (auto position = begin; position < end; ++position)
+        {
+            auto expected = Util::Scanner::Scalar::skip_luau_code(position, end);
+            assert(Util::Scanner::skip_luau_code(position, end, readable_end) == expected);
+#if CLUA_SCANNER_X86
+            assert(Util::Scanner::SSE2::skip_luau_code(position, end, readable_end) == expected);
+#endif
+        }
+    }
+
+    std::string brackets;
+    for (size_t i = 0; brackets.size() < 2048; ++i)
+    {
+        brackets += "]=]==] x]]=="[i % 12];
+        brackets.append(i % 13, i % 5 == 0 ? '=' : 'a');
+    }
+    brackets.append(Util::PaddedSource::padding, '\0');
+
+    auto brackets_begin = reinterpret_cast<const unsigned char*>(brackets.data());
+    auto brackets_end = brackets_begin + brackets.size() - Util::PaddedSource::padding;
+
+    for (size_t level = 0; level < 4; ++level)
+    {
+        for (auto position = brackets_begin; position < brackets_end; position += 3)
+        {
+            auto expected = Util::Scanner::Scalar::find_long_bracket_close(position, brackets_end, level);
+            assert(Util::Scanner::find_long_bracket_close(position, brackets_end, brackets_end, level) == expected);
+            assert(Util::Scanner::find_long_bracket_close(position, brackets_end, brackets_end + Util::PaddedSource::padding, level) == expected);
+        }
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_utf8_validation_test()
+{
+    std::cout << "[TEST] utf-8 validation kernels against the scalar version" << std::endl;
+
+    struct Case {
+        std::string text;
+        size_t invalid_at;
+    };
+
+    Case cases[] = {
+        { "plain ascii", 11 },
+        { "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80\xF4\x8F\xBF\xBF", 13 },
+        { "a\xC0\x80", 1 },          //overlong 2 byte
+        { "ab\xE0\x9F\xBF", 2 },     //overlong 3 byte
+        { "\xF0\x8F\xBF\xBF", 0 },   //overlong 4 byte
+        { "x\xED\xA0\x80", 1 },      //surrogate
+        { "\xF4\x90\x80\x80", 0 },   //past U+10FFFF
+        { "\xF8\x88\x80\x80\x80", 0 },
+        { "abc\x80", 3 },            //stray continuation
+        { "\xE2\x82", 0 },           //truncated by the end
+        { "\xC3" "a", 0 },
+    };
+
+    for (const auto& test_case : cases)
+    {
+        auto begin = reinterpret_cast<const unsigned char*>(test_case.text.data());
+        auto end = begin + test_case.text.size();
+        assert(Util::Scanner::Scalar::validate_utf8(begin, end) == begin + test_case.invalid_at);
+        assert(Util::Scanner::validate_utf8(begin, end) == begin + test_case.invalid_at);
+    }
+
+    //every case at every alignment inside long ascii and multibyte runs, so each one crosses block boundaries somewhere
+    for (const auto& test_case : cases)
+    {
+        for (size_t prefix_length = 0; prefix_length < 70; prefix_length++)
+        {
+            for (const char* filler : { "a", "\xC3\xA9", "\xE2\x82\xAC" })
+            {
+                std::string text;
+                while (text.size() < prefix_length)
+                {
+                    text += filler;
+                }
+                auto prefix_size = text.size();
+                text += test_case.text;
+                text.append(prefix_length % 3 == 0 ? 40 : 1, 'z');
+
+                auto begin = reinterpret_cast<const unsigned char*>(text.data());
+                auto end = begin + text.size();
+                auto expected = Util::Scanner::Scalar::validate_utf8(begin, end);
+
+                assert(expected == (test_case.invalid_at == test_case.text.size() ? end : begin + prefix_size + test_case.invalid_at));
+                assert(Util::Scanner::validate_utf8(begin, end) == expected);
+#if CLUA_SCANNER_X86
+                assert(Util::Scanner::SSE2::validate_utf8(begin, end) == expected);
+                if (__builtin_cpu_supports("avx2"))
+                {
+                    assert(Util::Scanner::AVX2::validate_utf8(begin, end) == expected);
+                }
+#endif
+            }
+        }
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_line_index_test()
+{
+    std::cout << "[TEST] line index against a naive line count" << std::endl;
+
+    std::string sources[] = {
+        "",
+        "\n",
+        "no final new line",
+        "a\nb\n\n\nc\n",
+        "",
+    };
+
+    //line lengths around the 16, 32 and 64 byte blocks of the counting kernels
+    for (size_t line_length : { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 200 })
+    {
+        sources[4] += std::string(line_length, 'x') + "\n";
+    }
+
+    for (const auto& source : sources)
+    {
+        Util::LineIndex index(source);
+        assert(!index.is_built());
+
+        size_t line = 1;
+        size_t column = 1;
+        for (size_t offset = 0; offset <= source.size(); offset++)
+        {
+            auto location = index.locate(offset);
+            assert(location.line == line && location.column == column);
+
+            if (offset < source.size() && source[offset] == '\n')
+            {
+                line++;
+                column = 1;
+            }
+            else
+            {
+                column++;
+            }
+        }
+
+        assert(index.is_built());
+        assert(index.line_count() == line);
+        assert(index.memory_bytes() == index.line_count() * sizeof(uint32_t));
+
+        auto past_end = index.locate(source.size() + 100);
+        auto at_end = index.locate(source.size());
+        assert(past_end.line == at_end.line && past_end.column == at_end.column);
+    }
+
+    Util::LineIndex index(sources[3]);
+    assert(index.line_text(1) == "a" && index.line_text(3) == "" && index.line_text(5) == "c" && index.line_text(6) == "");
+    assert(index.line_start(5) == 6);
+
+    //every count_byte kernel at every alignment
+    std::string text;
+    for (size_t position = 0; position < 300; position++)
+    {
+        text += position % 7 == 0 || position % 13 == 0 ? '\n' : 'y';
+    }
+    for (size_t start = 0; start < 70; start++)
+    {
+        for (size_t stop = start; stop <= text.size(); stop += 11)
+        {
+            auto begin = reinterpret_cast<const unsigned char*>(text.data()) + start;
+            auto end = reinterpret_cast<const unsigned char*>(text.data()) + stop;
+            auto expected = static_cast<size_t>(std::count(text.begin() + start, text.begin() + stop, '\n'));
+
+            assert(Util::Scanner::Scalar::count_byte(begin, end, '\n') == expected);
+            assert(Util::Scanner::count_byte(begin, end, '\n') == expected);
+#if CLUA_SCANNER_X86
+            assert(Util::Scanner::SSE2::count_byte(begin, end, '\n') == expected);
+            if (__builtin_cpu_supports("avx2"))
+            {
+                assert(Util::Scanner::AVX2::count_byte(begin, end, '\n') == expected);
+            }
+#endif
+        }
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_arena_test()
+{
+    std::cout << "[TEST] arena backed side tables" << std::endl;
+
+    Util::Arena arena(1024);
+    Util::Lexer arena_lexer(arena);
+
+    std::string inputs[] = {
+        "int a = 0x1F + 2.5; // comment\nfloat b = a << 3;\n",
+        "x $ y = 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16\n",
+    };
+
+    size_t first_high_water_mark = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (auto& input : inputs)
+        {
+            Util::Source source(reinterpret_cast<unsigned char*>(input.data()), input.size());
+
+            arena.reset();
+            arena_lexer.reset(source);
+
+            std::vector<Util::TokenGeneric> arena_tokens;
+            std::vector<Util::TokenGeneric> heap_tokens;
+            arena_lexer.tokenize_all(arena_tokens);
+
+            Util::Lexer heap_lexer(source);
+            heap_lexer.tokenize_all(heap_tokens);
+
+            assert(arena_tokens.size() == heap_tokens.size());
+            assert(arena_lexer.get_context().numbers.size() == heap_lexer.get_context().numbers.size());
+            assert(arena_lexer.get_context().symbols == heap_lexer.get_context().symbols);
+            assert(arena.stats().used_bytes > 0);
+        }
+
+        if (pass == 0)
+        {
+            first_high_water_mark = arena.stats().high_water_mark;
+        }
+    }
+
+    //the second pass fits in the blocks of the first one
+    assert(arena.stats().high_water_mark == first_high_water_mark);
+    assert(arena.stats().reserved_bytes >= first_high_water_mark);
+    assert(arena.stats().reset_count == 4);
+
+    auto reserved = arena.stats().reserved_bytes;
+    arena.reset();
+    auto big = arena.allocate_array<uint64_t>(1024);
+    assert(reinterpret_cast<uintptr_t>(big) % alignof(uint64_t) == 0);
+    assert(arena.stats().reserved_bytes > reserved);
+
+    arena.release();
+    assert(arena.stats().reserved_bytes == 0 && arena.stats().block_count == 0);
+
+    std::cout << "  OK\n";
+}
+
+void assert_same_streams(const Util::TokenStream& left, const Util::TokenStream& right)
+{
+    assert(left.size() == right.size());
+    for (size_t i = 0; i < left.size(); ++i)
+    {
+        assert(left.type(i) == right.type(i));
+        assert(left.offset(i) == right.offset(i));
+        assert(left.length(i) == right.length(i));
+        assert(left.flags(i) == right.flags(i));
+
+        if (left.type(i) == Util::TokenType::Symbol)
+        {
+            assert(left.symbol(i) == right.symbol(i));
+        }
+        else if (left.type(i) == Util::TokenType::Identifier)
+        {
+            assert(left.atom(i) == right.atom(i));
+        }
+    }
+}
+
+std::string repeat(const std::string& text, size_t repetitions)
+{
+    std::string repeated;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        repeated += text;
+    }
+    return repeated;
+}
+
+void run_parallel_lexer_test(const char* name, const std::string& input, bool expect_relex)
+{
+    std::cout << "[TEST] " << name << std::endl;
+
+    Util::PaddedSource padded_input(input);
+
+    Util::TokenStream sequential_stream;
+    Util::Source sequential_source = padded_input.view();
+    Util::Lexer(sequential_source).tokenize_all(sequential_stream);
+
+    Util::TokenStream parallel_stream;
+    Util::ParallelLexer::Options options;
+    options.thread_count = 4;
+    options.min_chunk_size = 64;
+    auto stats = Util::ParallelLexer::tokenize(padded_input.view(), parallel_stream, options);
+
+    assert(stats.chunk_count == 4);
+    assert((stats.relexed_chunks > 0) == expect_relex);
+    assert_same_streams(sequential_stream, parallel_stream);
+
+    std::cout << "  OK\n";
+}
+
+void run_incremental_lexer_test(const char* name, const std::string& old_text, size_t offset, size_t removed_length, const std::string& inserted)
+{
+    std::cout << "[TEST] " << name << std::endl;
+
+    std::string new_text = old_text;
+    new_text.replace(offset, removed_length, inserted);
+
+    Util::PaddedSource old_input(old_text);
+    Util::PaddedSource new_input(new_text);
+
+    //interned, so the relexed identifiers have to come back with the same atoms as the reused ones
+    Util::Interner interner;
+
+    Util::TokenStream old_stream;
+    Util::Source old_source = old_input.view();
+    Util::Lexer old_lexer(old_source);
+    old_lexer.set_interner(&interner);
+    old_lexer.tokenize_all(old_stream);
+
+    Util::TokenStream full_stream;
+    Util::Source full_source = new_input.view();
+    Util::Lexer full_lexer(full_source);
+    full_lexer.set_interner(&interner);
+    full_lexer.tokenize_all(full_stream);
+
+    Util::TokenStream incremental_stream;
+    auto stats = Util::IncrementalLexer::relex(old_stream, new_input.view(), { offset, removed_length, inserted }, incremental_stream, &interner);
+
+    assert_same_streams(incremental_stream, full_stream);
+    //the old EndOfFile token is always there to resync on, an unclosed comment just gets there later
+    assert(stats.resynced);
+    assert(stats.reused_prefix_tokens + stats.relexed_tokens + stats.reused_suffix_tokens == full_stream.size());
+    assert(stats.relexed_tokens < full_stream.size() / 4);
+
+    std::cout << "  OK\n";
+}
+
+void run_checkpoint_test()
+{
+    std::cout << "[TEST] lexer checkpoints" << std::endl;
+
+    //resuming from any checkpoint, whatever mode it was saved in, gives the rest of the full stream
+    auto check_resumes = [](Util::PaddedSource& padded_input, size_t checkpoint_interval) {
+        Util::TokenStream full_stream;
+        std::vector<Util::LexerCheckpoint> checkpoints;
+        Util::Source source = padded_input.view();
+        Util::Lexer(source).tokenize_all(full_stream, checkpoints, checkpoint_interval);
+
+        assert(checkpoints.front().index == 0);
+
+        for (const auto& checkpoint : checkpoints)
+        {
+            size_t first_token = 0;
+            while (full_stream.offset(first_token) < checkpoint.index)
+            {
+                ++first_token;
+            }
+            assert(full_stream.offset(first_token) == checkpoint.index);
+
+            Util::Lexer resumed_lexer;
+            Util::Source resumed_source = padded_input.view();
+            resumed_lexer.resume(resumed_source, checkpoint);
+
+            Util::TokenStream resumed_stream;
+            resumed_lexer.tokenize_all(resumed_stream);
+
+            assert(resumed_stream.size() == full_stream.size() - first_token);
+            for (size_t i = 0; i < resumed_stream.size(); ++i)
+            {
+                assert(resumed_stream.type(i) == full_stream.type(first_token + i));
+                assert(resumed_stream.offset(i) == full_stream.offset(first_token + i));
+                assert(resumed_stream.length(i) == full_stream.length(first_token + i));
+            }
+        }
+
+        return checkpoints.size();
+    };
+
+    auto input = repeat("int a = 0x1F; // frames\n@LUA [&b, c]{\n    t = { [[ } ]] }\n}\nfloat x = a << 2;\n", 12);
+    Util::PaddedSource padded_input(input);
+    assert(check_resumes(padded_input, 64) > input.size() / 128);
+
+    //multi byte characters a lua block can't start with are one token each, no checkpoint falls inside them
+    Util::PaddedSource unicode_input("@][😀{ x\n@[]本- = { }\n");
+    check_resumes(unicode_input, 1);
+
+    //speculative lexing: restore drops everything lexed after save
+    Util::Source speculative_source = padded_input.view();
+    Util::Lexer lexer(speculative_source);
+    for (int i = 0; i < 25; ++i)
+    {
+        lexer.process_next_token();
+    }
+
+    auto checkpoint = lexer.save();
+    std::vector<Util::TokenGeneric> first_pass;
+    for (int i = 0; i < 40; ++i)
+    {
+        first_pass.push_back(lexer.process_next_token());
+    }
+
+    lexer.restore(checkpoint);
+    assert(lexer.get_context().symbols.size() == checkpoint.symbol_count);
+    assert(lexer.get_context().numbers.size() == checkpoint.number_count);
+
+    for (const auto& expected : first_pass)
+    {
+        auto token = lexer.process_next_token();
+        assert(token.token_type == expected.token_type);
+        assert(token.offset == expected.offset);
+        assert(token.length == expected.length);
+        assert(token.payload_index == expected.payload_index);
+    }
+
+    std::cout << "  OK\n";
+}
+
+struct PieceReader {
+    const std::string& text;
+    size_t position = 0;
+    size_t piece_size;
+};
+
+void run_streaming_lexer_test(const char* name, const std::string& input, size_t piece_size, size_t chunk_size, size_t window_size)
+{
+    std::cout << "[TEST] " << name << std::endl;
+
+    Util::PaddedSource padded_input(input);
+    Util::Source source = padded_input.view();
+    Util::Interner interner;
+    Util::TokenStream full_stream;
+    Util::Lexer full_lexer(source);
+    full_lexer.set_interner(&interner);
+    full_lexer.tokenize_all(full_stream);
+
+    //hands out at most piece_size bytes per read, like a pipe would
+    PieceReader reader { input, 0, piece_size };
+    Util::StreamingLexer streaming_lexer([](void* context, unsigned char* destination, size_t capacity) -> long long {
+        auto& reader = *static_cast<PieceReader*>(context);
+        auto count = std::min({ capacity, reader.piece_size, reader.text.size() - reader.position });
+        std::memcpy(destination, reader.text.data() + reader.position, count);
+        reader.position += count;
+        return static_cast<long long>(count);
+    }, &reader, { chunk_size, window_size, &interner });
+
+    Util::TokenStream streamed_stream;
+    Util::TokenStream batch;
+    while (streaming_lexer.tokenize_next(batch))
+    {
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            streamed_stream.push_back_from(batch[i], batch);
+        }
+        batch.clear();
+    }
+
+    assert_same_streams(streamed_stream, full_stream);
+    assert(!streaming_lexer.has_failed());
+    if (input.find('\0') == std::string::npos)
+    {
+        assert(streaming_lexer.bytes_read() == input.size());
+    }
+    else
+    {
+        //a '\0' ends the input, the rest is neither read nor makes the window grow
+        assert(streaming_lexer.bytes_read() < input.size());
+        assert(streaming_lexer.see_window_size() == std::max(window_size, chunk_size));
+    }
+    assert(!streaming_lexer.tokenize_next(batch));
+
+    std::cout << "  OK\n";
+}
+
+void run_token_range_test()
+{
+    std::cout << "[TEST] token range" << std::endl;
+
+    std::string input = "int a = 1; // one\n@LUA [&a]{ print(a) }\nfloat b = a << 2;\n";
+    Util::Source source(reinterpret_cast<unsigned char*>(input.data()), input.size());
+
+    std::vector<Util::TokenGeneric> expected;
+    Util::Lexer(source).tokenize_all(expected);
+
+    Util::Lexer range_lexer(source);
+    size_t token_index = 0;
+    for (const auto& token : range_lexer.tokens())
+    {
+        assert(token.token_type == expected[token_index].token_type);
+        assert(token.offset == expected[token_index].offset);
+        assert(token.length == expected[token_index].length);
+        ++token_index;
+    }
+    assert(token_index == expected.size());
+
+    //trivia free tokens up to the lua block, without materializing anything
+    Util::Lexer view_lexer(source);
+    auto significant = view_lexer.tokens()
+        | std::views::filter([](const Util::TokenGeneric& token) { return !Util::is_trivia(token.token_type); })
+        | std::views::take_while([](const Util::TokenGeneric& token) { return token.token_type != Util::TokenType::LuaBlock; });
+
+    std::vector<Util::TokenType> significant_types;
+    for (const auto& token : significant)
+    {
+        significant_types.push_back(token.token_type);
+    }
+
+    std::vector<Util::TokenType> expected_types = {
+        Util::TokenType::Identifier, Util::TokenType::Identifier, Util::TokenType::Symbol, Util::TokenType::Numeric, Util::TokenType::Symbol,
+        Util::TokenType::Symbol, Util::TokenType::Identifier, Util::TokenType::Symbol, Util::TokenType::Symbol, Util::TokenType::Identifier, Util::TokenType::Symbol
+    };
+    assert(significant_types == expected_types);
+
+    //the range ends at the end of the source, also when the lexer is left inside a lua block
+    std::string cut_input = "int a;\n@LUA [a]";
+    Util::Source cut_source(reinterpret_cast<unsigned char*>(cut_input.data()), cut_input.size());
+    Util::Lexer cut_lexer(cut_source);
+    size_t cut_token_count = 0;
+    for (const auto& token : cut_lexer.tokens())
+    {
+        assert(token.offset <= cut_input.size());
+        ++cut_token_count;
+    }
+    assert(cut_token_count == 13);
+
+    std::cout << "  OK\n";
+}
+
+void run_trivia_skipping_test(const char* name, const std::string& input)
+{
+    std::cout << "[TEST] " << name << std::endl;
+
+    Util::PaddedSource padded_input(input);
+
+    std::vector<Util::TokenGeneric> all_tokens;
+    Util::Source keep_source = padded_input.view();
+    Util::Lexer(keep_source).tokenize_all(all_tokens);
+
+    std::vector<Util::TokenGeneric> significant_tokens;
+    Util::Source skip_source = padded_input.view();
+    Util::Lexer skip_lexer(skip_source);
+    skip_lexer.tokenize_all<Util::TriviaMode::Skip>(significant_tokens);
+
+    size_t significant_index = 0;
+    bool new_line_seen = false;
+    for (const auto& token : all_tokens)
+    {
+        if (Util::is_trivia(token.token_type))
+        {
+            auto text = std::string_view(input).substr(token.offset, token.length);
+            new_line_seen |= text.find('\n') != std::string_view::npos;
+            continue;
+        }
+
+        const auto& significant = significant_tokens[significant_index++];
+        assert(significant.token_type == token.token_type);
+        assert(significant.offset == token.offset);
+        assert(significant.length == token.length);
+        assert(((significant.flags & Util::TokenFlags::PrecededByNewLine) != 0) == new_line_seen);
+        new_line_seen = false;
+    }
+    assert(significant_index == significant_tokens.size());
+
+    std::cout << "  OK\n";
+}
+
+//post order, children inside their parent's token span and in source order, every node but the root has one parent
+void assert_well_formed(const ASTParser::Ast& ast)
+{
+    const auto& nodes = ast.nodes;
+    assert(ast.root == nodes.size() - 1);
+
+    std::vector<size_t> parent_counts(nodes.size(), 0);
+    for (ASTParser::NodeIndex node_index = 0; node_index < nodes.size(); node_index++)
+    {
+        auto span = nodes.span(node_index);
+        assert(span.first <= span.last && span.last < ast.tokens.size());
+
+        uint32_t previous_last = 0;
+        bool first_child = true;
+        for (auto child_index : nodes.children(node_index))
+        {
+            auto child_span = nodes.span(child_index);
+            assert(child_index < node_index);
+            assert(child_span.first >= span.first && child_span.last <= span.last);
+            assert(first_child || child_span.first > previous_last);
+            previous_last = child_span.last;
+            first_child = false;
+            parent_counts[child_index]++;
+        }
+    }
+
+    for (ASTParser::NodeIndex node_index = 0; node_index < ast.root; node_index++)
+    {
+        assert(parent_counts[node_index] == 1);
+    }
+}
+
+void run_parser_test(const char* name, const std::string& input, const std::string& expected_dump)
 {
-    std::cout << "[TEST] " << test.name << std::endl;
+    std::cout << "[TEST] " << name << std::endl;
 
-    Util::Source source(
-        reinterpret_cast<unsigned char*>(const_cast<char*>(test.input)),
-        std::strlen(test.input)
-    );
+    Util::PaddedSource padded_input(input);
+    Util::Source source = padded_input.view();
+    Util::Arena arena;
+    Util::Interner interner;
 
-    Util::Lexer lexer(source);
+    auto ast = ASTParser::Parser(source, arena, interner).parse();
+    auto actual_dump = ASTParser::dump(ast, ast.root);
 
-    for (size_t i = 0; i < TokenCount; ++i)
+    if (actual_dump != expected_dump)
     {
-        auto token = lexer.process_next_token();
+        std::cout << "  expected: " << expected_dump << "\n  actual:   " << actual_dump << std::endl;
+    }
+    assert(actual_dump == expected_dump);
+    assert(ast.errors.empty());
+    assert_well_formed(ast);
 
-        assert(token.token_type == test.expected_types[i]);
-        assert(token.offset == test.expected_offsets[i]);
-        assert(token.length == test.expected_lengths[i]);
+    std::cout << "  OK\n";
+}
+
+//broken input still gives a tree every node of which lies inside its parent, siblings in order and none left without a parent
+void run_parser_recovery_test()
+{
+    std::cout << "[TEST] parser recovery keeps the tree well formed" << std::endl;
+
+    struct Case {
+        const char* input;
+        const char* expected_dump;
+    };
+
+    Case cases[] = {
+        { "}", "(Module (Error))" },
+        { "a - @", "(Module (ExpressionStatement (Binary - (Identifier a) (Error))))" },
+        { "a ? @ : b", "(Module (ExpressionStatement (Conditional (Identifier a) (Error) (Identifier b))))" },
+        { "x = ;", "(Module (ExpressionStatement (Assignment = (Identifier x))))" },
+        { "f(a, )", "(Module (ExpressionStatement (Call (Identifier f) (Identifier a))))" },
+        { "{ x = }", "(Module (Block (ExpressionStatement (Assignment = (Identifier x)))))" },
+        { "for ;; { }\nfor x; { }", "(Module (For (Empty) (Empty) (Empty) (Block)) (For (Identifier x) (Block)))" },
+        { "( if )", nullptr },
+        { "buffer ! && << }", nullptr },
+        { "int f(, float", nullptr },
+        { "@LUA $ export[&a] $; &&", nullptr },
+        { "@LUA [,]{ } export [a,] as", nullptr },
+        { "int a;\n@LUA [a]", nullptr },
+    };
+
+    for (const auto& test_case : cases)
+    {
+        Util::PaddedSource padded_input(test_case.input);
+        Util::Source source = padded_input.view();
+        Util::Arena arena;
+        Util::Interner interner;
+
+        auto ast = ASTParser::Parser(source, arena, interner).parse();
+
+        assert(!ast.errors.empty());
+        assert_well_formed(ast);
+        if (test_case.expected_dump)
+        {
+            assert(ASTParser::dump(ast, ast.root) == test_case.expected_dump);
+        }
     }
 
-    if (test.expect_error)
+    std::cout << "  OK\n";
+}
+
+void run_parser_file_test(const char* path, bool expect_lexer_error)
+{
+    std::cout << "[TEST] parsing " << path << std::endl;
+
+    auto padded_input = Util::PaddedSource::from_file(path);
+    if (!padded_input)
     {
-        assert(lexer.get_last_error().error_code == test.expected_error);
+        std::cout << "  skipped\n";
+        return;
+    }
+
+    Util::Source source = padded_input->view();
+    Util::Arena arena;
+    Util::Interner interner;
+
+    auto ast = ASTParser::Parser(source, arena, interner).parse();
+
+    assert(ast.tokens.type(ast.tokens.size() - 1) == Util::TokenType::EndOfFile);
+    assert(ast.nodes.kind(ast.root) == ASTParser::NodeKind::Module);
+
+    //the only thing the files get wrong is lexical, a.clua's 0.0f or an unclosed lua block
+    if (expect_lexer_error)
+    {
+        assert(ast.errors.size() == 1);
+        assert(ast.errors.front().error_code == ASTParser::ParseErrorCode::LexerError);
+    } else {
+        assert(ast.errors.empty());
+        assert_well_formed(ast);
+    }
+
+    std::cout << "  OK\n";
+}
+
+void run_diagnostics_test()
+{
+    std::cout << "[TEST] diagnostics for every error in one pass" << std::endl;
+
+    std::string input =
+        "int a = 0.0f;\n"
+        "int b = ;\n"
+        "foo(1 2)\n"
+        "char c = 'xy'\n"
+        "int d = 1\n";
+
+    Util::PaddedSource padded_input(input);
+    Util::Source source = padded_input.view();
+    Util::Arena arena;
+    Util::Interner interner;
+
+    auto ast = ASTParser::Parser(source, arena, interner).parse();
+    auto diagnostics = Diagnostics::collect(ast, input);
+
+    //each broken statement is reported once and parsing picks up again on the next line
+    auto statements = ast.nodes.children(ast.root);
+    assert(statements.size() == 5);
+    assert(ast.nodes.kind(statements[4]) == ASTParser::NodeKind::VariableDeclaration);
+
+    const char* expected[] = {
+        "t.clua:1:9: error: malformed number",
+        "t.clua:2:9: error: expected an expression",
+        "t.clua:3:7: error: expected ')'",
+        "t.clua:4:10: error: char holds more than one character",
+    };
+
+    assert(diagnostics.size() == std::size(expected));
+    assert(diagnostics.error_count() == std::size(expected));
+    for (size_t diagnostic_index = 0; diagnostic_index < diagnostics.size(); diagnostic_index++)
+    {
+        auto text = diagnostics.format(diagnostics[diagnostic_index], "t.clua");
+        if (text != expected[diagnostic_index])
+        {
+            std::cout << "  expected: " << expected[diagnostic_index] << "\n  actual:   " << text << std::endl;
+        }
+        assert(text == expected[diagnostic_index]);
+    }
+
+    auto end_location = diagnostics.locate(input.size());
+    assert(end_location.line == 6 && end_location.column == 1);
+
+    std::cout << "  OK\n";
+}
+
+void run_number_value_test()
+{
+    std::cout << "[TEST] number values decoded while lexing" << std::endl;
+
+    std::string input =
+        "0x1F 0b101 42 18446744073709551615 18446744073709551616 0xffffFFFFffffFFFF 0x10000000000000000 "
+        "0.5 .25 3.14159 0.12345678901234567891 100000000000000000000.0 "
+        "0." + std::string(330, '0') + "1 " + std::string(400, '9') + ".0 0b" + std::string(65, '1') + " 7)";
+
+    Util::PaddedSource padded_input(input);
+    Util::Source source = padded_input.view();
+    Util::TokenStream tokens;
+    Util::Lexer(source).tokenize_all<Util::TriviaMode::Skip>(tokens);
+
+    auto integer = [&tokens](size_t token_index) {
+        assert(tokens.type(token_index) == Util::TokenType::Numeric);
+        assert(tokens.number(token_index).number_type == Util::NumberType::Integer);
+        return tokens.number(token_index).integer_value;
+    };
+    auto floating = [&tokens](size_t token_index) {
+        assert(tokens.type(token_index) == Util::TokenType::Numeric);
+        assert(tokens.number(token_index).number_type == Util::NumberType::Float);
+        return tokens.number(token_index).float_value;
+    };
+    auto overflows = [&tokens](size_t token_index) {
+        return tokens.type(token_index) == Util::TokenType::Error && tokens.error(token_index).error_code == Util::ErrorCode::NumberOverflow;
+    };
+
+    assert(integer(0) == 0x1F);
+    assert(integer(1) == 5);
+    assert(integer(2) == 42);
+    assert(integer(3) == UINT64_MAX);
+    assert(overflows(4));
+    assert(integer(5) == UINT64_MAX);
+    assert(overflows(6));
+
+    assert(floating(7) == 0.5);
+    assert(floating(8) == 0.25);
+    assert(floating(9) == 3.14159);
+    assert(tokens.number(9).flags == 0);
+    assert(floating(10) == 0.12345678901234567891);
+    assert(tokens.number(10).flags == Util::NumberFlags::PrecisionLoss);
+    assert(floating(11) == 1e20 && tokens.number(11).flags == 0);
+    assert(floating(12) == 0 && tokens.number(12).flags == Util::NumberFlags::Underflow);
+    assert(overflows(13));
+    assert(overflows(14));
+
+    //hex, binary and decimal integers may all be followed by a symbol
+    assert(integer(15) == 7);
+    assert(tokens.symbol(16) == SymbolClassifier::SymbolKind::RPAREN);
+
+    std::cout << "  OK\n";
+}
+
+void run_interner_test()
+{
+    std::cout << "[TEST] identifier interning" << std::endl;
+
+    Util::Interner interner;
+
+    auto first = interner.intern("value");
+    assert(interner.intern("value") == first);
+    assert(interner.intern("values") != first);
+    assert(interner.intern("") != first && interner.intern("") == interner.intern(""));
+    assert(interner.text(first) == "value");
+    assert(interner.size() == 3);
+
+    //enough names to grow every shard several times, interned from a few threads at once in different orders
+    constexpr size_t name_count = 20000;
+    constexpr size_t thread_count = 4;
+    std::vector<std::vector<Util::Atom>> atoms(thread_count,std::vector<Util::Atom>(name_count));
+    std::vector<std::thread> threads;
+
+    for (size_t thread_index = 0; thread_index < thread_count; thread_index++)
+    {
+        threads.emplace_back([&atoms, &interner, thread_index]() {
+            for (size_t step = 0; step < name_count; step++)
+            {
+                auto name_index = thread_index % 2 ? name_count - 1 - step : step;
+                atoms[thread_index][name_index] = interner.intern("name_" + std::to_string(name_index));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t name_index = 0; name_index < name_count; name_index++)
+    {
+        for (size_t thread_index = 1; thread_index < thread_count; thread_index++)
+        {
+            assert(atoms[thread_index][name_index] == atoms[0][name_index]);
+        }
+        assert(interner.text(atoms[0][name_index]) == "name_" + std::to_string(name_index));
     }
+    assert(interner.size() == 3 + name_count);
+
+    //the lexer hands the atoms out, captures resolve against declarations by comparing them
+    std::string input = "int a = 1\nint b = 2\n@LUA [&b, a]{ }\n";
+
+    Util::PaddedSource padded_input(input);
+    Util::Source source = padded_input.view();
+    Util::Arena arena;
+
+    auto ast = ASTParser::Parser(source, arena, interner).parse();
+    assert(ast.errors.empty());
+
+    auto statements = ast.nodes.children(ast.root);
+    auto captures = ast.nodes.children(ast.nodes.children(statements[2])[0]);
+
+    assert(captures.size() == 2);
+    assert(ast.atom(captures[0]) == ast.atom(statements[1]));
+    assert(ast.atom(captures[1]) == ast.atom(statements[0]));
+    assert(ast.atom(captures[1]) == interner.intern("a"));
+
+    //without an interner identifiers still lex, just without identity
+    Util::TokenStream tokens;
+    Util::Lexer(source).tokenize_all(tokens);
+    assert(tokens.type(0) == Util::TokenType::Identifier && tokens.atom(0) == Util::no_atom);
 
     std::cout << "  OK\n";
 }
@@ -126,21 +1230,286 @@ Test<4> UNCLOSED_BLOCK_COMMENT {
 };
 
 
-Test<4> UNICODE_CHARACTERS_IN_IDENTIFIER {
+Test<2> UNICODE_CHARACTERS_IN_IDENTIFIER {
     "unicode characters test",
     "asdxxź",
     {
         Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 7 },
+    { 7, 1 }
+};
+
+Test<6> UNICODE_IN_STRINGS_AND_COMMENTS {
+    "unicode in strings and comments",
+    "\"żółw\" // ñandú\nπ",
+    {
+        Util::TokenType::String,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Comment,
+        Util::TokenType::NewLine,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 9, 10, 20, 21, 23 },
+    { 9, 1, 10, 1, 2, 1 }
+};
+
+Test<4> MALFORMED_UTF8_IN_STRING {
+    "malformed utf-8 makes its string one error",
+    "\"a\xC0\xAF" "b\" x",
+    {
+        Util::TokenType::Error,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 6, 7, 8 },
+    { 6, 1, 1, 1 },
+    true,
+    Util::ErrorCode::InvalidByte
+};
+
+Test<5> MALFORMED_UTF8_IN_IDENTIFIER {
+    "malformed utf-8 splits an identifier",
+    "é\xED\xA0\x80é\xF0\x9F\x98",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Error,
+        Util::TokenType::Identifier,
+        Util::TokenType::Error,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 2, 5, 7, 10 },
+    { 2, 3, 2, 3, 1 },
+    true,
+    Util::ErrorCode::TruncatedUnicodeSequence
+};
+
+
+Test<8> OPERATOR_MAXIMAL_MUNCH {
+    "operator maximal munch",
+    "a<<=b->c>>d",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 1, 4, 5, 7, 8, 10, 11 },
+    { 1, 3, 1, 2, 1, 2, 1, 1 }
+};
+
+Test<4> UNKNOWN_SYMBOL {
+    "unknown symbol",
+    "a$b",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Error,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 1, 2, 3 },
+    { 1, 1, 1, 1 },
+    true,
+    Util::ErrorCode::UnknownSymbol
+};
+
+Test<7> MALFORMED_NUMBER_TAKES_ITS_WORD {
+    "malformed number takes the rest of its word",
+    "x = 0.0f;",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Error,
+        Util::TokenType::Symbol,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 1, 2, 3, 4, 8, 9 },
+    { 1, 1, 1, 1, 4, 1, 1 },
+    true,
+    Util::ErrorCode::MalformedNumber
+};
+
+Test<8> UNCLOSED_STRING_ENDS_AT_LINE_END {
+    "unclosed string ends at the line end",
+    "s = \"abc\nx",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Error,
+        Util::TokenType::NewLine,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 1, 2, 3, 4, 8, 9, 10 },
+    { 1, 1, 1, 1, 4, 1, 1, 1 },
+    true,
+    Util::ErrorCode::UnclosedString
+};
+
+Test<6> ESCAPES_DONT_SKIP_THE_CLOSING_QUOTE {
+    "escapes don't skip the closing quote",
+    "\"\\\"\" \"\\\\\" x",
+    {
+        Util::TokenType::String,
+        Util::TokenType::Whitespace,
+        Util::TokenType::String,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 4, 5, 9, 10, 11 },
+    { 4, 1, 4, 1, 1, 1 }
+};
+
+Test<4> BACKSLASH_AT_LINE_END_CLOSES_NOTHING {
+    "backslash at the line end leaves the string unclosed",
+    "\"ab\\\nx",
+    {
+        Util::TokenType::Error,
+        Util::TokenType::NewLine,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 4, 5, 6 },
+    { 4, 1, 1, 1 },
+    true,
+    Util::ErrorCode::UnclosedString
+};
+
+Test<4> TOO_LONG_CHAR {
+    "too long char is one error",
+    "'ab' x",
+    {
         Util::TokenType::Error,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Identifier,
+        Util::TokenType::EndOfFile
+    },
+    { 0, 4, 5, 6 },
+    { 4, 1, 1, 1 },
+    true,
+    Util::ErrorCode::TooLongChar
+};
+
+Test<9> LUA_BLOCK_WITH_COMMENT_AND_STRINGS {
+    "lua block with a comment and strings holding braces",
+    "@LUA [a]{ -- c { }\n  x = \"}\" .. [[ } ]] - 1 }\nint y;",
+    {
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
+        Util::TokenType::LuaBlock,
+        Util::TokenType::NewLine,
+        Util::TokenType::Identifier
+    },
+    { 0, 1, 4, 5, 6, 7, 8, 45, 46 },
+    { 1, 3, 1, 1, 1, 1, 37, 1, 3 }
+};
+
+Test<6> UNCLOSED_LUA_BLOCK_IN_COMMENT {
+    "lua block ending inside an inline comment",
+    "@LUA []{ -- never closed",
+    {
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Symbol,
+        Util::TokenType::Error
+    },
+    { 0, 1, 4, 5, 6, 7 },
+    { 1, 3, 1, 1, 1, 17 },
+    true,
+    Util::ErrorCode::UnclosedLuaBlock
+};
+
+Test<8> LUA_LONG_BRACKETS {
+    "lua long brackets with mismatched and overlapping closers",
+    "@LUA []{ s = [==[ ]] ]=] ]===] ]]==] ]==] t = [[ a]=]] }\nx",
+    {
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Symbol,
+        Util::TokenType::LuaBlock,
+        Util::TokenType::NewLine,
+        Util::TokenType::Identifier
+    },
+    { 0, 1, 4, 5, 6, 7, 56, 57 },
+    { 1, 3, 1, 1, 1, 49, 1, 1 }
+};
+
+Test<13> LUA_CAPTURE_CUT_BY_END_OF_FILE {
+    "file ending between a lua capture and its block",
+    "int a;\n@LUA [a]",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
+        Util::TokenType::NewLine,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Symbol,
         Util::TokenType::Error,
         Util::TokenType::EndOfFile
     },
-    { 0, 5, 6, 7},
-    { 5, 1, 1, 1},
+    { 0, 3, 4, 5, 6, 7, 8, 11, 12, 13, 14, 15, 15 },
+    { 3, 1, 1, 1, 1, 1, 3, 1, 1, 1, 1, 0, 1 },
+    true,
+    Util::ErrorCode::UnclosedLuaBlock
+};
+
+Test<6> UNCLOSED_LUA_LONG_BRACKET {
+    "unclosed lua long bracket",
+    "@LUA []{ s = [=[ ]] ",
+    {
+        Util::TokenType::Symbol,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Symbol,
+        Util::TokenType::Symbol,
+        Util::TokenType::Error
+    },
+    { 0, 1, 4, 5, 6, 7 },
+    { 1, 3, 1, 1, 1, 13 },
     true,
-    Util::ErrorCode::UnexpectedCharacter
+    Util::ErrorCode::UnclosedLuaBlock
 };
 
+Test<7> LONG_RUNS {
+    "long identifier, whitespace and comment runs",
+    "a_very_long_identifier_name_0123456789xyz                    /* a ** long * block comment / that spans blocks */ x // inline comment that is longer than a single 32 byte block",
+    {
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Comment,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Identifier,
+        Util::TokenType::Whitespace,
+        Util::TokenType::Comment,
+    },
+    { 0, 41, 61, 112, 113, 114, 115 },
+    { 41, 20, 51, 1, 1, 1, 60 }
+};
 
     run_test(IDENTIFIER_ONLY);
     run_test(IDENTIFIER_WHITESPACE_IDENTIFIER);
@@ -149,6 +1518,125 @@ Test<4> UNICODE_CHARACTERS_IN_IDENTIFIER {
     run_test(INLINE_COMMENT);
     run_test(UNCLOSED_BLOCK_COMMENT);
     run_test(UNICODE_CHARACTERS_IN_IDENTIFIER);
+    run_test(UNICODE_IN_STRINGS_AND_COMMENTS);
+    run_test(MALFORMED_UTF8_IN_STRING);
+    run_test(MALFORMED_UTF8_IN_IDENTIFIER);
+    run_test(OPERATOR_MAXIMAL_MUNCH);
+    run_test(UNKNOWN_SYMBOL);
+    run_test(MALFORMED_NUMBER_TAKES_ITS_WORD);
+    run_test(UNCLOSED_STRING_ENDS_AT_LINE_END);
+    run_test(ESCAPES_DONT_SKIP_THE_CLOSING_QUOTE);
+    run_test(BACKSLASH_AT_LINE_END_CLOSES_NOTHING);
+    run_test(TOO_LONG_CHAR);
+    run_test(LONG_RUNS);
+    run_test(LUA_BLOCK_WITH_COMMENT_AND_STRINGS);
+    run_test(UNCLOSED_LUA_BLOCK_IN_COMMENT);
+    run_test(LUA_LONG_BRACKETS);
+    run_test(UNCLOSED_LUA_LONG_BRACKET);
+    run_test(LUA_CAPTURE_CUT_BY_END_OF_FILE);
+    run_luau_skipper_test();
+    run_utf8_validation_test();
+    run_line_index_test();
+
+    run_batch_test("batch tokenization over a padded source",
+        "@LUA [&b,a]{\n    b += 5 print(\"b\", b)\n} export [a,b] as [c,d];\n"
+        "int main() {\n    /* block */ float x = 0.016; // inline\n    return static_cast<int>(0x1F);\n}\n"
+    );
+
+    run_batch_test("comment running into the padding", "x = 1 /* unclosed block comment that runs to the end of the file");
+    run_batch_test("identifier running into the padding", "x = identifier_that_runs_to_the_end_of_the_file");
+    run_batch_test("lua long bracket running into the padding", "@LUA []{ data = [==[ ]] ]=] ]]=]=");
+    run_batch_test("lua capture running into the padding", "int a;\n@LUA [a]");
+
+    run_token_stream_test();
+    run_number_value_test();
+    run_from_file_test(4096);
+    run_from_file_test(10000);
+    run_parallel_driver_test();
+    run_arena_test();
+
+    run_parallel_lexer_test("parallel lexing of top level code",
+        repeat("@LUA [&b]{\n    print(b)\n}\nint frame_count = 0; // frames\nfloat clamp(float v) {\n    return v;\n}\n", 40), false);
+    run_parallel_lexer_test("parallel lexing with split points inside a block comment",
+        "int x;\n/*\n" + repeat("int commented_out = 0;\n", 40) + "*/\nint y;\n", true);
+    run_parallel_lexer_test("parallel lexing with split points inside a lua block",
+        "@LUA []{\n" + repeat("local_value = { 1 }\n", 40) + "}\nint y;\n", true);
+    run_parallel_lexer_test("parallel lexing stops at a nul byte",
+        repeat("int frame_count = 0; // frames\n", 10) + std::string(1, '\0') + repeat("int frame_count = 0; // frames\n", 30), false);
+
+    run_checkpoint_test();
+    run_token_range_test();
+
+    run_trivia_skipping_test("trivia skipping over mixed code",
+        "int a = 1; // one\n  /* two\n lines */ float b /* inline */ = a;\n@LUA [&a, b] { print(a) -- lua\n }\n\treturn b\n");
+    run_trivia_skipping_test("trivia skipping keeps unclosed comment errors", "int a;\n/* never closed\n");
+    for (auto path : { "clua_examples/a.clua", "clua_examples/b.clua" })
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (file)
+        {
+            run_trivia_skipping_test(path, std::string(std::istreambuf_iterator<char>(file), {}));
+        }
+    }
+
+    auto streaming_input = repeat("int a = 0x1F; // frames\n@LUA [&b, c]{\n    t = { [==[ } ]] ]==] } -- }\n}\n/* block\n comment */ float x = a << 2;\n", 30);
+    run_streaming_lexer_test("streaming lexer over small pieces", streaming_input, 7, 16, 64);
+    run_streaming_lexer_test("streaming lexer with large chunks", streaming_input, 4096, 1024, 2048);
+    run_streaming_lexer_test("streaming lexer growing the window for a long comment",
+        "int a;\n/*" + repeat("long comment body ", 40) + "*/ int b;\n", 5, 16, 32);
+    run_streaming_lexer_test("streaming lexer on an unclosed lua block",
+        "@LUA []{ s = [[" + repeat("never closed ", 20), 3, 8, 16);
+    run_streaming_lexer_test("streaming lexer cutting utf-8 sequences",
+        repeat("żółw = \"ñandú 😀\" // ☃\n\xE2\x82 x\xC0\xAF = 1\n", 12) + "end\xF0\x9F", 5, 8, 16);
+    run_streaming_lexer_test("streaming lexer cutting string escapes",
+        repeat("s = \"\\n\\\"\";\n", 20) + "\"\\", 1, 8, 16);
+    run_streaming_lexer_test("streaming lexer on a lua capture cut by the end of the input", "int a;\n@LUA [a]", 1, 8, 16);
+    run_streaming_lexer_test("streaming lexer cutting unexpected multi byte characters", "@[]本- = { ", 1, 10, 1);
+    run_streaming_lexer_test("streaming lexer stopping at a nul byte",
+        repeat("int a = 0;\n", 20) + std::string(1, '\0') + repeat("int a = 0;\n", 4000), 64, 64, 256);
+
+    auto incremental_input = repeat("int frame_count = 0; // frames\n@LUA [&b]{\n    print(b)\n}\nfloat clamp(float v) {\n    return v;\n}\n", 20);
+    auto edit_offset = incremental_input.size() / 2;
+    run_incremental_lexer_test("incremental relex of an inserted statement",
+        incremental_input, edit_offset, 0, "int inserted = 1;\n");
+    run_incremental_lexer_test("incremental relex of a removed lua block",
+        incremental_input, incremental_input.find("@LUA", edit_offset), 26, "");
+    run_incremental_lexer_test("incremental relex of an edit inside a lua block",
+        incremental_input, incremental_input.find("print", edit_offset), 5, "local x = { '}' } print");
+    run_incremental_lexer_test("incremental relex growing an identifier",
+        incremental_input, incremental_input.find("frame_count", edit_offset) + 5, 0, "_x");
+    run_incremental_lexer_test("incremental relex opening a block comment",
+        incremental_input, edit_offset, 0, "/*");
+    run_incremental_lexer_test("incremental relex at the start of the file",
+        incremental_input, 0, 3, "float");
+    run_incremental_lexer_test("incremental relex of a lua capture typed at the end of the file",
+        incremental_input + "int a;\n", incremental_input.size() + 7, 0, "@[a]");
+
+    run_parser_test("parser operator precedence",
+        "x = a + b * c - -d << 2 == e && f || g ? h : i = j;",
+        "(Module (ExpressionStatement (Assignment = (Identifier x) (Conditional (Binary || (Binary && (Binary == (Binary << (Binary - (Binary + (Identifier a) (Binary * (Identifier b) (Identifier c))) (Unary - (Identifier d))) (NumberLiteral 2)) (Identifier e)) (Identifier f)) (Identifier g)) (Identifier h) (Assignment = (Identifier i) (Identifier j))))))");
+    run_parser_test("parser postfix chains and casts",
+        "velocity.y = clamp(velocity.y, -50.0, v[i++])\nreturn static_cast<vec3*>(p)->x",
+        "(Module (ExpressionStatement (Assignment = (Member y (Identifier velocity)) (Call (Identifier clamp) (Member y (Identifier velocity)) (Unary - (NumberLiteral 50.0)) (Index (Identifier v) (Postfix ++ (Identifier i)))))) (Return (Member x (Cast static_cast (Type vec3*) (Identifier p)))))");
+    run_parser_test("parser declarations without semicolons",
+        "buffer vec3 position\nextern float system_tick()\nvirtual void update(vec3& pos, const float dt) {\n    pos += dt\n    (pos)\n}",
+        "(Module (VariableDeclaration position (Type vec3)) (FunctionDeclaration system_tick (Type float) (ParameterList)) (FunctionDeclaration update (Type void) (ParameterList (Parameter pos (Type vec3&)) (Parameter dt (Type float))) (Block (ExpressionStatement (Assignment += (Identifier pos) (Identifier dt))) (ExpressionStatement (Identifier pos)))))");
+    run_parser_test("parser control flow",
+        "for int i = 0; i < 10; i += 1 { if (i == 5) break; else continue }\nfor (;;) ;\nwhile x { x-- }",
+        "(Module (For (VariableDeclaration i (Type int) (NumberLiteral 0)) (Binary < (Identifier i) (NumberLiteral 10)) (Assignment += (Identifier i) (NumberLiteral 1)) (Block (If (Binary == (Identifier i) (NumberLiteral 5)) (Break) (Continue)))) (For (Empty) (Empty) (Empty) (Empty)) (While (Identifier x) (Block (ExpressionStatement (Postfix -- (Identifier x))))))");
+    run_parser_test("parser lua statement with captures and export",
+        "@LUA [&b, a, copy dt]{\n    a += 1 -- }\n} export [a] as [c];\n@LUA []{ }",
+        "(Module (LuaStatement (CaptureList (Capture &b) (Capture a) (Capture copy dt)) (LuaCode) (Export (NameList (Identifier a)) (NameList (Identifier c)))) (LuaStatement (CaptureList) (LuaCode)))");
+    run_parser_file_test("clua_examples/a.clua", true);
+    run_parser_file_test("clua_examples/b.clua", false);
+    run_parser_recovery_test();
+
+    auto capture_path = unique_temp_path("clua_parser_capture_test", ".clua");
+    std::ofstream(capture_path, std::ios::binary) << "int a;\n@LUA [a]";
+    run_parser_file_test(capture_path.string().c_str(), true);
+    std::filesystem::remove(capture_path);
+    run_diagnostics_test();
+    run_interner_test();
 
     std::cout << "\nAll lexer tests passed.\n";
     return 0;